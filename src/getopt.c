@@ -52,46 +52,16 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include "getopt_internal.h"
+
 #include <errno.h>
-#include <getopt.h>
+#include <limits.h>
 #include <stdarg.h>
+#if defined(GETOPT_STDIO_DIAGNOSTICS)
 #include <stdio.h>
+#endif
 #include <stdlib.h>
 #include <string.h>
-#if defined(HAVE_STD_INT) || (defined __STDC__ && defined __STDC_VERSION__ && __STDC_VERSION__ >= 199901L)
-#include <stdint.h>
-#elif !defined(_UINTPTR_T_DEFINED) && !defined(UINTPTR_MAX)
-/* uintptr_t does not exist so need to define what type it is as best we can */
-/* Checking known data model macros first and Windows predefined macros */
-#if defined(__LP64__) || defined(_LP64) || defined(__ILP64__) || defined(_ILP64)
-typedef unsigned long uintptr_t;
-#define UINTPTR_MAX FFFFFFFFFFFFFFFFUL;
-#elif defined(_WIN32)
-#if defined(_WIN64)
-typedef unsigned long long uintptr_t;
-#define UINTPTR_MAX FFFFFFFFFFFFFFFFULL;
-#else
-typedef unsigned long uintptr_t;
-#define UINTPTR_MAX FFFFFFFFUL;
-#endif
-#elif defined(__ILP32__) || defined(_ILP32) || defined(__LP32__) || defined(_LP32)
-typedef unsigned long uintptr_t;
-#define UINTPTR_MAX FFFFFFFFUL;
-#else /* done checking macros for various known data models. Fall back to CPU macros */
-#if defined(_WIN64) || defined(_M_IA64) || defined(_M_ALPHA) || defined(_M_X64) || defined(_M_AMD64) ||                \
-    defined(__alpha__) || defined(__amd64__) || defined(__x86_64__) || defined(__aarch64__) || defined(__ia64__) ||    \
-    defined(__IA64__) || defined(__powerpc64__) || defined(__PPC64__) || defined(__ppc64__) ||                         \
-    defined(_ARCH_PPC64) // 64bit
-/* 64bit and Windows already handled, so assuming unsigned long*/
-typedef unsigned long uintptr_t;
-#define UINTPTR_MAX FFFFFFFFFFFFFFFFUL
-#else
-/* 32bit, use unsigned long*/
-typedef unsigned long uintptr_t;
-#define UINTPTR_MAX FFFFFFFFUL;
-#endif
-#endif
-#endif // checking for stdint
 #if defined(_WIN32)
 #if defined(_MSC_VER) && !defined(__clang__)
 #define DISABLE_WARNING_4255 __pragma(warning(push)) __pragma(warning(disable : 4255))
@@ -104,7 +74,7 @@ typedef unsigned long uintptr_t;
 DISABLE_WARNING_4255
 #include <windows.h>
 RESTORE_WARNING_4255
-#else
+#elif defined(GETOPT_STDIO_DIAGNOSTICS)
 #include <libgen.h> /*for basename*/
 #endif              /*_WIN32*/
 
@@ -120,19 +90,43 @@ int optopt = '?'; /* character checked for validity */
 #endif          /*__MINGW32__*/
 int   optreset; /* reset getopt */
 char* optarg;   /* argument associated with option */
+int   optmode;  /* GETOPT_MODE_* syntax extensions */
 #endif          /*REPLACE_GETOPT*/
 
-#define PRINT_ERROR ((opterr) && (*options != ':'))
+/* how slash_option_kind() classifies a word */
+#define SLASH_NONE  0 /* operand */
+#define SLASH_LONG  1 /* /name long option */
+#define SLASH_SHORT 2 /* /x short option */
+
+/*
+ * States of the getopt_internal_r() scanner. A call starts in SCAN_WORD,
+ * or in SCAN_OPTION when d->place is still inside a cluster of short
+ * options, and runs until a state returns or hands over to SCAN_SHORT.
+ * The states make the word classification and resumption explicit; they
+ * are not faster than the loop they replaced, since characters inside a
+ * cluster still take the short option path one call at a time.
+ */
+#define SCAN_WORD    0 /* fetch nargv[d->optind] and classify its first byte */
+#define SCAN_OPERAND 1 /* non-option: return it, stop, or skip it for permutation */
+#define SCAN_DASH    2 /* "-...": classify the second byte */
+#define SCAN_DOUBLE  3 /* "--" terminator or "--name" */
+#define SCAN_SLASH   4 /* "/..." in GETOPT_MODE_SLASH */
+#define SCAN_OPTION  5 /* option at d->place: long option probe */
+#define SCAN_SHORT   6 /* option character at d->place */
+
+/* byte classes that drive the scanner */
+#define CC_OTHER 0
+#define CC_END   1 /* '\0' */
+#define CC_DASH  2 /* '-' */
+#define CC_SLASH 3 /* '/' */
 
-#define FLAG_PERMUTE  0x01 /* permute non-options to the end of argv */
-#define FLAG_ALLARGS  0x02 /* treat non-options as args to option "-1" */
-#define FLAG_LONGONLY 0x04 /* operate as getopt_long_only */
+static const unsigned char getopt_char_class[UCHAR_MAX + 1] = {['\0'] = CC_END, ['-'] = CC_DASH, ['/'] = CC_SLASH};
 
-/* return values */
-#define BADCH   (int)'?'
-#define BADARG  ((*options == ':') ? (int)':' : (int)'?')
-#define INORDER (int)1
+/* next state from the first byte of a word, and from the byte after a '-' */
+static const unsigned char scan_lead_state[] = {SCAN_OPERAND, SCAN_OPERAND, SCAN_DASH, SCAN_SLASH};
+static const unsigned char scan_dash_state[] = {SCAN_OPTION, SCAN_OPTION, SCAN_DOUBLE, SCAN_OPTION};
 
+#if defined(GETOPT_STDIO_DIAGNOSTICS)
 /*
  * expand this long list of definitions for systems that DO have __progname
  * create an elif defined list for systems that have something similar, but named differently or other functions
@@ -173,6 +167,7 @@ extern const char* __progname; // NOLINT
 #define NEED_PROGNAME
 /*This will define our own global to store the programe name into -TJE*/
 #endif /*Checking PROGNAME capabilities*/
+#endif /*GETOPT_STDIO_DIAGNOSTICS*/
 
 #ifdef __CYGWIN__
 static char EMSG[] = "";
@@ -180,33 +175,37 @@ static char EMSG[] = "";
 #define EMSG ""
 #endif
 
-static int  getopt_internal(int, char* const*, const char*, const struct option*, int*, int);
-static int  parse_long_options(char* const*, const char*, const struct option*, int*, int, int);
-static int  gcd(int, int);
+static int parse_long_options(char* const*, const char*, const getoptLongTable*, int*, int, int, struct getopt_context*);
+static int gcd(int, int);
 static void permute_args(int, int, int, char* const*);
 
-static char* place = (char*)(uintptr_t)EMSG; /* option letter processing */
+/*
+ * State behind the optind/optarg/... globals. getopt_internal() copies the
+ * globals in and out of it around each call to getopt_internal_r().
+ */
+static struct getopt_context getopt_global_context = GETOPT_CONTEXT_INIT;
 
-/* XXX: set optreset to 1 rather than these two */
-static int nonopt_start = -1; /* first non option argument (for permute) */
-static int nonopt_end   = -1; /* first option after non options (for permute) */
+#if !defined(DISABLE_GETOPT_DIAGNOSTICS)
+static getopt_diagnostic_fn getopt_diagnostic_handler;
+static void*                getopt_diagnostic_user;
+#endif
 
 /*
- * Due to Warning about non-const format string, using an enum since this code uses
- * it's own internal implementation of warnings/errors to select a constant string
- * This warning only happens in Clang, but rather than disabling an otherwise useful
- * warning, this enum can map to the correct warning/error output for us.
+ * getopt_set_diagnostic_handler --
+ *	Route diagnostics to handler instead of stderr.
  */
-typedef enum eGetoptErrorMessageEnum
+void getopt_set_diagnostic_handler(getopt_diagnostic_fn handler, void* user)
 {
-    GETOPT_ERR_MSG_RECARGCHAR,
-    GETOPT_ERR_MSG_RECARGSTRING,
-    GETOPT_ERR_MSG_AMBIG,
-    GETOPT_ERR_MSG_NOARG,
-    GETOPT_ERR_MSG_ILLOPTCHAR,
-    GETOPT_ERR_MSG_ILLOPTSTRING
-} eGetoptErrorMessage;
+#if !defined(DISABLE_GETOPT_DIAGNOSTICS)
+    getopt_diagnostic_handler = handler;
+    getopt_diagnostic_user    = user;
+#else
+    (void)handler;
+    (void)user;
+#endif
+}
 
+#if defined(GETOPT_STDIO_DIAGNOSTICS)
 #if defined(NEED_PROGNAME)
 char* getopt_progname;
 #endif /*NEED_PROGNAME*/
@@ -271,7 +270,7 @@ static char* getopt_getprogname(void)
  * defining our own versions here to help prevent them from coliding. -TJE
  */
 
-static void getopt_vwarnx(eGetoptErrorMessage errmsg, va_list ap)
+static void getopt_vprintwarnx(eGetoptErrorMessage errmsg, va_list ap)
 {
     char* progname = getopt_getprogname();
 #if (defined(HAVE_FPRINTF_S) && defined(HAVE_VFPRINTF_S)) ||                                                           \
@@ -302,6 +301,30 @@ static void getopt_vwarnx(eGetoptErrorMessage errmsg, va_list ap)
     case GETOPT_ERR_MSG_ILLOPTSTRING:
         (void)vfprintf_s(stderr, "unknown option -- %s", ap);
         break;
+    case GETOPT_ERR_MSG_BADVALUE:
+        (void)vfprintf_s(stderr, "invalid argument -- %s", ap);
+        break;
+    case GETOPT_ERR_MSG_NOSPACE:
+        (void)vfprintf_s(stderr, "too many arguments -- %s", ap);
+        break;
+    case GETOPT_ERR_MSG_ILLCOMMAND:
+        (void)vfprintf_s(stderr, "unknown command -- %s", ap);
+        break;
+    case GETOPT_ERR_MSG_AMBIGCOMMAND:
+        (void)vfprintf_s(stderr, "ambiguous command -- %s", ap);
+        break;
+    case GETOPT_ERR_MSG_ARGCLIMIT:
+        (void)vfprintf_s(stderr, "argument list too long -- %d", ap);
+        break;
+    case GETOPT_ERR_MSG_TOKENLIMIT:
+        (void)vfprintf_s(stderr, "argument too long -- %.*s...", ap);
+        break;
+    case GETOPT_ERR_MSG_CLUSTERLIMIT:
+        (void)vfprintf_s(stderr, "too many options in one argument -- %c", ap);
+        break;
+    case GETOPT_ERR_MSG_CONFLICT:
+        (void)vfprintf_s(stderr, "conflicting option -- %s", ap);
+        break;
     }
     (void)fprintf_s(stderr, "\n");
 #else  /* MSFT's/C11 Annex K's _s functions not available/used */
@@ -329,6 +352,30 @@ static void getopt_vwarnx(eGetoptErrorMessage errmsg, va_list ap)
     case GETOPT_ERR_MSG_ILLOPTSTRING:
         (void)vfprintf(stderr, "unknown option -- %s", ap);
         break;
+    case GETOPT_ERR_MSG_BADVALUE:
+        (void)vfprintf(stderr, "invalid argument -- %s", ap);
+        break;
+    case GETOPT_ERR_MSG_NOSPACE:
+        (void)vfprintf(stderr, "too many arguments -- %s", ap);
+        break;
+    case GETOPT_ERR_MSG_ILLCOMMAND:
+        (void)vfprintf(stderr, "unknown command -- %s", ap);
+        break;
+    case GETOPT_ERR_MSG_AMBIGCOMMAND:
+        (void)vfprintf(stderr, "ambiguous command -- %s", ap);
+        break;
+    case GETOPT_ERR_MSG_ARGCLIMIT:
+        (void)vfprintf(stderr, "argument list too long -- %d", ap);
+        break;
+    case GETOPT_ERR_MSG_TOKENLIMIT:
+        (void)vfprintf(stderr, "argument too long -- %.*s...", ap);
+        break;
+    case GETOPT_ERR_MSG_CLUSTERLIMIT:
+        (void)vfprintf(stderr, "too many options in one argument -- %c", ap);
+        break;
+    case GETOPT_ERR_MSG_CONFLICT:
+        (void)vfprintf(stderr, "conflicting option -- %s", ap);
+        break;
     }
     (void)fprintf(stderr, "\n");
 #endif // MSFT secure lib
@@ -338,13 +385,104 @@ static void getopt_vwarnx(eGetoptErrorMessage errmsg, va_list ap)
         progname = NULL;
     }
 }
+#endif /*GETOPT_STDIO_DIAGNOSTICS*/
 
-static void getopt_warnx(eGetoptErrorMessage errmsg, ...)
+#if !defined(DISABLE_GETOPT_DIAGNOSTICS)
+/*
+ * Hand a diagnostic to the handler as an error code and the option it is
+ * about: a character in optopt, or len bytes of name.
+ */
+static void getopt_vdiagnose(eGetoptErrorMessage errmsg, va_list ap)
 {
+    int         error, optchar = 0, len = -1;
+    const char* name = NULL;
+
+    switch (errmsg)
+    {
+    case GETOPT_ERR_MSG_RECARGCHAR:
+        error   = GETOPT_ERROR_MISSING_ARGUMENT;
+        optchar = va_arg(ap, int);
+        break;
+    case GETOPT_ERR_MSG_RECARGSTRING:
+        error = GETOPT_ERROR_MISSING_ARGUMENT;
+        name  = va_arg(ap, const char*);
+        break;
+    case GETOPT_ERR_MSG_AMBIG:
+        error = GETOPT_ERROR_AMBIGUOUS;
+        len   = va_arg(ap, int);
+        name  = va_arg(ap, const char*);
+        break;
+    case GETOPT_ERR_MSG_NOARG:
+        error = GETOPT_ERROR_UNEXPECTED_ARGUMENT;
+        len   = va_arg(ap, int);
+        name  = va_arg(ap, const char*);
+        break;
+    case GETOPT_ERR_MSG_ILLOPTCHAR:
+        error   = GETOPT_ERROR_UNKNOWN_OPTION;
+        optchar = va_arg(ap, int);
+        break;
+    case GETOPT_ERR_MSG_ILLOPTSTRING:
+        error = GETOPT_ERROR_UNKNOWN_OPTION;
+        name  = va_arg(ap, const char*);
+        break;
+    case GETOPT_ERR_MSG_BADVALUE:
+        error = GETOPT_ERROR_INVALID_VALUE;
+        name  = va_arg(ap, const char*);
+        break;
+    case GETOPT_ERR_MSG_NOSPACE:
+        error = GETOPT_ERROR_NO_SPACE;
+        name  = va_arg(ap, const char*);
+        break;
+    case GETOPT_ERR_MSG_ILLCOMMAND:
+        error = GETOPT_ERROR_UNKNOWN_COMMAND;
+        name  = va_arg(ap, const char*);
+        break;
+    case GETOPT_ERR_MSG_ARGCLIMIT:
+        error = GETOPT_ERROR_TOO_MANY_ARGS;
+        (void)va_arg(ap, int);
+        break;
+    case GETOPT_ERR_MSG_TOKENLIMIT:
+        error = GETOPT_ERROR_TOKEN_TOO_LONG;
+        len   = va_arg(ap, int);
+        name  = va_arg(ap, const char*);
+        break;
+    case GETOPT_ERR_MSG_CLUSTERLIMIT:
+        error   = GETOPT_ERROR_CLUSTER_TOO_LONG;
+        optchar = va_arg(ap, int);
+        break;
+    case GETOPT_ERR_MSG_CONFLICT:
+        error = GETOPT_ERROR_CONFLICT;
+        name  = va_arg(ap, const char*);
+        break;
+    case GETOPT_ERR_MSG_AMBIGCOMMAND:
+    default:
+        error = GETOPT_ERROR_AMBIGUOUS;
+        name  = va_arg(ap, const char*);
+        break;
+    }
+    getopt_diagnostic_handler(getopt_diagnostic_user,
+                              error,
+                              optchar,
+                              name,
+                              name == NULL ? 0 : (len >= 0 ? (size_t)len : getopt_strlen(name)));
+}
+#endif /*!DISABLE_GETOPT_DIAGNOSTICS*/
+
+void getopt_warnx(eGetoptErrorMessage errmsg, ...)
+{
+#if !defined(DISABLE_GETOPT_DIAGNOSTICS)
     va_list ap;
     va_start(ap, errmsg);
-    getopt_vwarnx(errmsg, ap);
+    if (getopt_diagnostic_handler != NULL)
+        getopt_vdiagnose(errmsg, ap);
+#if defined(GETOPT_STDIO_DIAGNOSTICS)
+    else
+        getopt_vprintwarnx(errmsg, ap);
+#endif
     va_end(ap);
+#else
+    (void)errmsg;
+#endif
 }
 
 /*
@@ -365,7 +503,7 @@ static int gcd(int a, int b)
     return (b);
 }
 
-static size_t getopt_strlen(const char* str)
+size_t getopt_strlen(const char* str)
 {
     if (str)
     {
@@ -443,99 +581,432 @@ static void permute_args(int panonopt_start, int panonopt_end, int opt_end, char
 }
 
 /*
- * parse_long_options --
- *	Parse long options in argc/argv argument vector.
- * Returns -1 if short_too is set and the option does not match long_options.
+ * Accessors for a getoptLongTable. Index i must be below the end reported by
+ * longopt_end(). A registry has no flat index; getopt_longopt_match() resolves a
+ * name to one of its tables first.
+ */
+static int longopt_end(const getoptLongTable* table, int i)
+{
+    if (table->packed != NULL)
+        return (i >= table->packed->count);
+    return (table->options[i].name == NULL);
+}
+
+static int longopt_has_arg(const getoptLongTable* table, int i)
+{
+    if (table->packed != NULL)
+        return (PACKED_OPTION_HAS_ARG(table->packed->options[i].info));
+    return (table->options[i].has_arg);
+}
+
+static int* longopt_flag(const getoptLongTable* table, int i)
+{
+    if (table->packed != NULL)
+    {
+        int slot = PACKED_OPTION_FLAG_SLOT(table->packed->options[i].info);
+        return (slot == 0 ? NULL : table->packed->flag_slots[slot - 1]);
+    }
+    return (table->options[i].flag);
+}
+
+static int longopt_val(const getoptLongTable* table, int i)
+{
+    if (table->packed != NULL)
+        return (table->packed->options[i].val);
+    return (table->options[i].val);
+}
+
+/*
+ * ASCII case folding for GETOPT_MODE_NOCASE, a machine word at a time.
+ * Only 'A'-'Z' change, so the result does not depend on the locale and
+ * bytes of UTF-8 sequences are left alone.
  */
-static int parse_long_options(char* const*         nargv,
-                              const char*          options,
-                              const struct option* long_options,
-                              int*                 idx,
-                              int                  short_too,
-                              int                  flags)
+#define FOLD_ONES (~(uintptr_t)0 / 0xFF) /* 0x01 in every byte */
+
+static uintptr_t fold_word(uintptr_t x)
 {
-    char * current_argv, *has_equal;
-    size_t current_argv_len;
-    int    i, match, exact_match, second_partial_match;
+    uintptr_t low   = x & (FOLD_ONES * 0x7F);
+    uintptr_t ge_a  = low + FOLD_ONES * (0x80 - 'A'); /* high bit set from 'A' up */
+    uintptr_t gt_z  = low + FOLD_ONES * (0x7F - 'Z'); /* high bit set above 'Z' */
+    uintptr_t upper = (ge_a ^ gt_z) & ~x & (FOLD_ONES * 0x80);
+
+    return (x | (upper >> 2)); /* 0x80 >> 2 is the case bit */
+}
 
-    current_argv         = place;
-    match                = -1;
-    exact_match          = 0;
-    second_partial_match = 0;
+int getopt_fold_char(int c)
+{
+    return ((c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c);
+}
 
-    optind++;
+/*
+ * Compare len bytes of a and b ignoring ASCII case, two words per step.
+ * b_folded says b is already in lower case.
+ */
+static int fold_equal(const char* a, const char* b, size_t len, int b_folded)
+{
+    uintptr_t a0, a1, b0, b1;
 
-    if ((has_equal = strchr(current_argv, '=')) != NULL)
+    while (len >= 2 * sizeof(uintptr_t))
     {
-        /* argument found (--option=arg) */
-        current_argv_len = (uintptr_t)has_equal - (uintptr_t)current_argv;
-        has_equal++;
+        memcpy(&a0, a, sizeof(uintptr_t));
+        memcpy(&a1, a + sizeof(uintptr_t), sizeof(uintptr_t));
+        memcpy(&b0, b, sizeof(uintptr_t));
+        memcpy(&b1, b + sizeof(uintptr_t), sizeof(uintptr_t));
+        if (!b_folded)
+        {
+            b0 = fold_word(b0);
+            b1 = fold_word(b1);
+        }
+        if (((fold_word(a0) ^ b0) | (fold_word(a1) ^ b1)) != 0)
+            return (0);
+        a += 2 * sizeof(uintptr_t);
+        b += 2 * sizeof(uintptr_t);
+        len -= 2 * sizeof(uintptr_t);
     }
-    else
-        current_argv_len = getopt_strlen(current_argv);
+    if (len >= sizeof(uintptr_t))
+    {
+        memcpy(&a0, a, sizeof(uintptr_t));
+        memcpy(&b0, b, sizeof(uintptr_t));
+        if (fold_word(a0) != (b_folded ? b0 : fold_word(b0)))
+            return (0);
+        a += sizeof(uintptr_t);
+        b += sizeof(uintptr_t);
+        len -= sizeof(uintptr_t);
+    }
+    for (; len > 0; len--, a++, b++)
+    {
+        if (getopt_fold_char((unsigned char)*a) != (b_folded ? (unsigned char)*b : getopt_fold_char((unsigned char)*b)))
+            return (0);
+    }
+    return (1);
+}
+
+/*
+ * Compare the first len characters of arg with the name of long option i,
+ * ignoring ASCII case if nocase is set. Returns 0 if they differ, 1 if arg
+ * is a proper prefix of the name and 2 if it is an exact match.
+ */
+static int longopt_compare(const getoptLongTable* table, int i, const char* arg, size_t len, int nocase)
+{
+    size_t name_len;
+
+    if (table->packed != NULL)
+    {
+        const struct packed_option* entry = &table->packed->options[i];
+        if (entry->name_len < len)
+            return (0);
+        if (!nocase)
+        {
+            if (memcmp(arg, table->packed->pool + entry->name_off, len) != 0)
+                return (0);
+        }
+        else if (table->packed->folded != NULL)
+        {
+            if (!fold_equal(arg, table->packed->folded + entry->name_off, len, 1))
+                return (0);
+        }
+        else if (!fold_equal(arg, table->packed->pool + entry->name_off, len, 0))
+            return (0);
+        return (entry->name_len == len ? 2 : 1);
+    }
+    if (!nocase)
+    {
+        if (strncmp(arg, table->options[i].name, len) != 0)
+            return (0);
+        return (getopt_strlen(table->options[i].name) == len ? 2 : 1);
+    }
+    /* the word compare may read len bytes of the name */
+    name_len = getopt_strlen(table->options[i].name);
+    if (name_len < len || !fold_equal(arg, table->options[i].name, len, 0))
+        return (0);
+    return (name_len == len ? 2 : 1);
+}
+
+/*
+ * Match the first len characters of arg against the long options of table,
+ * continuing the search recorded in m. With all_partial, arg is known to
+ * abbreviate the namespace of every entry, so each one is a partial match.
+ */
+static void longopt_match_table(const getoptLongTable* table,
+                                int                    base,
+                                const char*            arg,
+                                size_t                 len,
+                                int                    all_partial,
+                                int                    short_too,
+                                int                    flags,
+                                longoptMatch*          m)
+{
+    int i, cmp;
 
-    for (i = 0; long_options[i].name; i++)
+    for (i = 0; !longopt_end(table, i); i++)
     {
         /* find matching long option */
-        if (strncmp(current_argv, long_options[i].name, current_argv_len) != 0)
+        if ((cmp = all_partial ? 1 : longopt_compare(table, i, arg, len, flags & FLAG_NOCASE)) == 0)
             continue;
 
-        if (getopt_strlen(long_options[i].name) == current_argv_len)
+        if (cmp == 2)
         {
             /* exact match */
-            match       = i;
-            exact_match = 1;
-            break;
+            m->table = *table;
+            m->index = i;
+            m->base  = base;
+            m->exact = 1;
+            return;
         }
         /*
          * If this is a known short option, don't allow
          * a partial match of a single character.
          */
-        if (short_too && current_argv_len == 1)
+        if (short_too && len == 1)
             continue;
 
-        if (match == -1) /* first partial match */
-            match = i;
-        else if ((flags & FLAG_LONGONLY) || long_options[i].has_arg != long_options[match].has_arg ||
-                 long_options[i].flag != long_options[match].flag || long_options[i].val != long_options[match].val)
-            second_partial_match = 1;
+        if (m->index == -1)
+        { /* first partial match */
+            m->table = *table;
+            m->index = i;
+            m->base  = base;
+        }
+        else if ((flags & FLAG_LONGONLY) || longopt_has_arg(table, i) != longopt_has_arg(&m->table, m->index) ||
+                 longopt_flag(table, i) != longopt_flag(&m->table, m->index) ||
+                 longopt_val(table, i) != longopt_val(&m->table, m->index))
+            m->ambiguous = 1;
+    }
+}
+
+/*
+ * Compare len characters at name with a registered namespace prefix, as
+ * strcmp() would order them.
+ */
+int getopt_namespace_compare(const struct getopt_namespace* space, const char* name, size_t len)
+{
+    size_t n = space->prefix_len < len ? space->prefix_len : len;
+    int    cmp;
+
+    if ((cmp = memcmp(space->prefix, name, n)) != 0)
+        return (cmp);
+    return (space->prefix_len < len ? -1 : (space->prefix_len > len ? 1 : 0));
+}
+
+/*
+ * Index of the first namespace whose prefix does not sort before name.
+ */
+int getopt_namespace_lower_bound(const struct getopt_registry* registry, const char* name, size_t len)
+{
+    int lo = 0, hi = registry->count, mid;
+
+    while (lo < hi)
+    {
+        mid = lo + (hi - lo) / 2;
+        if (getopt_namespace_compare(&registry->spaces[mid], name, len) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return (lo);
+}
+
+/*
+ * Match a long option name against a registry. The result is the one a
+ * single table would give with every option renamed to "prefix.name", the
+ * namespace-less options first and then the namespaces in prefix order.
+ */
+static void longopt_match_registry(const struct getopt_registry* registry,
+                                   const char*                   arg,
+                                   size_t                        len,
+                                   int                           short_too,
+                                   int                           flags,
+                                   longoptMatch*                 m)
+{
+    const char*     sep = memchr(arg, GETOPT_NAMESPACE_SEPARATOR, len);
+    getoptLongTable table = {NULL, NULL, NULL};
+    size_t          prefix_len;
+    int             n;
+
+    n = 0;
+    if (registry->count > 0 && registry->spaces[0].prefix_len == 0)
+    {
+        /* options without a namespace */
+        table.options = registry->spaces[0].options;
+        longopt_match_table(&table, 0, arg, len, 0, short_too, flags, m);
+        if (m->exact)
+            return;
+        n = 1;
+    }
+    if (flags & FLAG_NOCASE)
+    {
+        /*
+         * The namespaces are sorted by their exact spelling, so look at
+         * each one; there are far fewer namespaces than options.
+         */
+        prefix_len = sep != NULL ? (size_t)((uintptr_t)sep - (uintptr_t)arg) : len;
+        for (; n < registry->count; n++)
+        {
+            const struct getopt_namespace* space = &registry->spaces[n];
+            if (space->prefix_len == 0 || space->prefix_len < prefix_len ||
+                (sep != NULL && space->prefix_len != prefix_len) || !fold_equal(arg, space->prefix, prefix_len, 0))
+                continue;
+            table.options = space->options;
+            if (sep != NULL)
+                longopt_match_table(&table, n << 16, sep + 1, len - prefix_len - 1, 0, 0, flags, m);
+            else
+                longopt_match_table(&table, n << 16, arg, len, 1, short_too, flags, m);
+            if (m->exact)
+                return;
+        }
+        return;
+    }
+    if (sep != NULL)
+    {
+        /* "ns.name" can only be in namespace ns */
+        prefix_len = (uintptr_t)sep - (uintptr_t)arg;
+        n          = getopt_namespace_lower_bound(registry, arg, prefix_len);
+        if (n < registry->count && prefix_len > 0 &&
+            getopt_namespace_compare(&registry->spaces[n], arg, prefix_len) == 0)
+        {
+            table.options = registry->spaces[n].options;
+            longopt_match_table(&table, n << 16, sep + 1, len - prefix_len - 1, 0, 0, flags, m);
+        }
+        return;
     }
-    if (!exact_match && second_partial_match)
+    /* "ns" alone abbreviates every option of each namespace it is a prefix of */
+    if (len > 0)
+        n = getopt_namespace_lower_bound(registry, arg, len);
+    for (; n < registry->count && registry->spaces[n].prefix_len >= len &&
+           memcmp(registry->spaces[n].prefix, arg, len) == 0;
+         n++)
+    {
+        table.options = registry->spaces[n].options;
+        longopt_match_table(&table, n << 16, arg, len, 1, short_too, flags, m);
+    }
+}
+
+/*
+ * Resolve the first len characters of arg to a long option.
+ */
+void getopt_longopt_match(const getoptLongTable* long_options,
+                          const char*            arg,
+                          size_t                 len,
+                          int                    short_too,
+                          int                    flags,
+                          longoptMatch*          m)
+{
+    m->index     = -1;
+    m->base      = 0;
+    m->exact     = 0;
+    m->ambiguous = 0;
+    if (long_options->registry != NULL)
+        longopt_match_registry(long_options->registry, arg, len, short_too, flags, m);
+    else
+        longopt_match_table(long_options, 0, arg, len, 0, short_too, flags, m);
+}
+
+/*
+ * Nonzero if token is longer than d->limits allows. Reads no more than
+ * max_token + 1 bytes of it. No word can be longer than SIZE_MAX, and
+ * max_token + 1 would wrap to 0 for it, so that is no limit.
+ */
+static int token_over_limit(const struct getopt_context* d, const char* token)
+{
+    return (d->limits != NULL && d->limits->max_token > 0 && d->limits->max_token != (size_t)(-1) && token != NULL &&
+            memchr(token, '\0', d->limits->max_token + 1) == NULL);
+}
+
+/*
+ * Report a word that token_over_limit() rejected, showing only its start.
+ */
+static int token_too_long(const char* options, const char* token, int optchar, struct getopt_context* d)
+{
+    size_t shown = d->limits->max_token < 32 ? d->limits->max_token : 32;
+
+    if (PRINT_ERROR)
+        getopt_warnx(GETOPT_ERR_MSG_TOKENLIMIT, (int)shown, token);
+    d->error  = GETOPT_ERROR_TOKEN_TOO_LONG;
+    d->optopt = optchar;
+    return (BADCH);
+}
+
+/*
+ * parse_long_options --
+ *	Parse long options in argc/argv argument vector.
+ * Returns -1 if short_too is set and the option does not match long_options.
+ */
+static int parse_long_options(char* const*           nargv,
+                              const char*            options,
+                              const getoptLongTable* long_options,
+                              int*                   idx,
+                              int                    short_too,
+                              int                    flags,
+                              struct getopt_context* d)
+{
+    char *                 current_argv, *has_equal;
+    size_t                 current_argv_len;
+    int                    match;
+    int*                   flag;
+    longoptMatch           m;
+    const getoptLongTable* table = &m.table;
+
+    current_argv = d->place;
+
+    d->optind++;
+
+    if ((has_equal = (flags & FLAG_SLASHARG) ? strpbrk(current_argv, ":=") : strchr(current_argv, '=')) != NULL)
+    {
+        /* argument found (--option=arg, /option:arg) */
+        current_argv_len = (uintptr_t)has_equal - (uintptr_t)current_argv;
+        has_equal++;
+    }
+    else
+        current_argv_len = getopt_strlen(current_argv);
+
+    getopt_longopt_match(long_options, current_argv, current_argv_len, short_too, flags, &m);
+    match = m.index;
+    if (!m.exact && m.ambiguous)
     {
         /* ambiguous abbreviation */
         if (PRINT_ERROR)
             getopt_warnx(GETOPT_ERR_MSG_AMBIG, (int)current_argv_len, current_argv);
-        optopt = 0;
+        d->error  = GETOPT_ERROR_AMBIGUOUS;
+        d->optopt = 0;
         return (BADCH);
     }
     if (match != -1)
     { /* option found */
-        if (long_options[match].has_arg == no_argument && has_equal)
+        if (longopt_has_arg(table, match) == no_argument && has_equal)
         {
             if (PRINT_ERROR)
                 getopt_warnx(GETOPT_ERR_MSG_NOARG, (int)current_argv_len, current_argv);
+            d->error = GETOPT_ERROR_UNEXPECTED_ARGUMENT;
             /*
              * XXX: GNU sets optopt to val regardless of flag
              */
-            if (long_options[match].flag == NULL)
-                optopt = long_options[match].val;
+            if (longopt_flag(table, match) == NULL)
+                d->optopt = longopt_val(table, match);
             else
-                optopt = 0;
+                d->optopt = 0;
             return (BADARG);
         }
-        if (long_options[match].has_arg == required_argument || long_options[match].has_arg == optional_argument)
+        if (longopt_has_arg(table, match) == required_argument ||
+            longopt_has_arg(table, match) == optional_argument)
         {
             if (has_equal)
-                optarg = has_equal;
-            else if (long_options[match].has_arg == required_argument)
+                d->optarg = has_equal;
+            else if (longopt_has_arg(table, match) == required_argument)
             {
                 /*
                  * optional argument doesn't use next nargv
                  */
-                optarg = nargv[optind++];
+                d->optarg = nargv[d->optind++];
+                if (token_over_limit(d, d->optarg))
+                {
+                    d->optarg = NULL;
+                    return (token_too_long(options,
+                                           nargv[d->optind - 1],
+                                           longopt_flag(table, match) == NULL ? longopt_val(table, match) : 0,
+                                           d));
+                }
             }
         }
-        if ((long_options[match].has_arg == required_argument) && (optarg == NULL))
+        if ((longopt_has_arg(table, match) == required_argument) && (d->optarg == NULL))
         {
             /*
              * Missing argument; leading ':' indicates no error
@@ -543,14 +1014,15 @@ static int parse_long_options(char* const*         nargv,
              */
             if (PRINT_ERROR)
                 getopt_warnx(GETOPT_ERR_MSG_RECARGSTRING, current_argv);
+            d->error = GETOPT_ERROR_MISSING_ARGUMENT;
             /*
              * XXX: GNU sets optopt to val regardless of flag
              */
-            if (long_options[match].flag == NULL)
-                optopt = long_options[match].val;
+            if (longopt_flag(table, match) == NULL)
+                d->optopt = longopt_val(table, match);
             else
-                optopt = 0;
-            --optind;
+                d->optopt = 0;
+            --d->optind;
             return (BADARG);
         }
     }
@@ -558,46 +1030,171 @@ static int parse_long_options(char* const*         nargv,
     { /* unknown option */
         if (short_too)
         {
-            --optind;
+            --d->optind;
             return (-1);
         }
         if (PRINT_ERROR)
             getopt_warnx(GETOPT_ERR_MSG_ILLOPTSTRING, current_argv);
-        optopt = 0;
+        d->error  = GETOPT_ERROR_UNKNOWN_OPTION;
+        d->optopt = 0;
         return (BADCH);
     }
     if (idx)
-        *idx = match;
-    if (long_options[match].flag)
+        *idx = m.base + match;
+    if ((flag = longopt_flag(table, match)) != NULL)
     {
-        *long_options[match].flag = long_options[match].val;
+        if (!(flags & FLAG_NOSTORE))
+            *flag = longopt_val(table, match);
         return (0);
     }
     else
-        return (long_options[match].val);
+        return (longopt_val(table, match));
+}
+
+/*
+ * In GETOPT_MODE_SLASH, decide whether a word starting with '/' is an
+ * option or an operand such as an absolute path. options must already be
+ * past any leading '+' or '-'. Does not consume anything.
+ */
+static int slash_option_kind(const char* token, const char* options, const getoptLongTable* long_options, int flags)
+{
+    const char*  name = token + 1;
+    size_t       len;
+    int          short_ok;
+    longoptMatch m;
+
+    if (token[0] != '/')
+        return (SLASH_NONE);
+    len = strcspn(name, ":=");
+    if (len == 0 || memchr(name, '/', len) != NULL)
+        return (SLASH_NONE);
+    short_ok = (len == 1 && strchr(options, name[0]) != NULL);
+    if (long_options != NULL)
+    {
+        /* as with getopt_long_only, a known short option beats an abbreviation */
+        getopt_longopt_match(long_options, name, len, short_ok, flags & FLAG_NOCASE, &m);
+        if (m.index != -1)
+            return (SLASH_LONG);
+    }
+    return (short_ok ? SLASH_SHORT : SLASH_NONE);
+}
+
+/*
+ * Parse the /option at nargv[d->optind], classified by slash_option_kind().
+ */
+static int parse_slash_option(int                    nargc,
+                              char* const*           nargv,
+                              const char*            options,
+                              const getoptLongTable* long_options,
+                              int*                   idx,
+                              int                    flags,
+                              int                    kind,
+                              struct getopt_context* d)
+{
+    char*       token = nargv[d->optind];
+    const char* oli;
+    int         optchar;
+
+    d->optpos = d->optind;
+    if (kind == SLASH_LONG)
+    {
+        d->place = token + 1;
+        optchar  = parse_long_options(nargv, options, long_options, idx, 0, flags | FLAG_SLASHARG, d);
+        d->place = (char*)(uintptr_t)EMSG;
+        return (optchar);
+    }
+
+    /* /x, /x:arg, /x=arg or /x arg */
+    optchar  = (int)token[1];
+    oli      = strchr(options, optchar);
+    d->place = (char*)(uintptr_t)EMSG;
+    d->optind++;
+    if (oli[1] != ':')
+    {
+        if (token[2] != '\0')
+        {
+            if (PRINT_ERROR)
+                getopt_warnx(GETOPT_ERR_MSG_NOARG, 1, token + 1);
+            d->error  = GETOPT_ERROR_UNEXPECTED_ARGUMENT;
+            d->optopt = optchar;
+            return (BADARG);
+        }
+        return (optchar);
+    }
+    if (token[2] != '\0')
+        d->optarg = token + 3;
+    else if (oli[2] != ':')
+    {
+        if (d->optind >= nargc)
+        { /* no arg */
+            if (PRINT_ERROR)
+                getopt_warnx(GETOPT_ERR_MSG_RECARGCHAR, optchar);
+            d->error  = GETOPT_ERROR_MISSING_ARGUMENT;
+            d->optopt = optchar;
+            return (BADARG);
+        }
+        d->optarg = nargv[d->optind++];
+        if (token_over_limit(d, d->optarg))
+        {
+            d->optarg = NULL;
+            return (token_too_long(options, nargv[d->optind - 1], optchar, d));
+        }
+    }
+    return (optchar);
 }
 
 static const char* posixlycorrectenv = "POSIXLY_CORRECT";
 
 /*
- * getopt_internal --
- *	Parse argc/argv argument vector.  Called by user level routines.
+ * Whether POSIXLY_CORRECT is set in the environment.
  */
-static int getopt_internal(int                  nargc,
-                           char* const*         nargv,
-                           const char*          options,
-                           const struct option* long_options,
-                           int*                 idx,
-                           int                  flags)
+int getopt_posixly_correct(void)
 {
-    const char* oli; /* option letter list index */
-    int         optchar, short_too;
-    static int  posixly_correct = -1;
+#if defined(HAVE_GETENV_S) || (defined(_WIN32) && defined(_MSC_VER) && defined(__STDC_SECURE_LIB__)) ||                \
+    (defined(__STDC_LIB_EXT1__) && defined(__STDC_WANT_LIB_EXT1__))
+    /* MSFT/C11 annex K adds getenv_s, so use it when available to check if this exists */
+    size_t size = 0;
+    /*
+     * You can allocate a buffer based off of size and call it again to read it,
+     * however, this is not necessary. We just need to know if this exists or not
+     * since that is how to getenv line below was set to work before this _s function was added.
+     */
+    return (getenv_s(&size, NULL, 0, posixlycorrectenv) == 0);
+#elif defined(HAVE_SECURE_GETENV) && !defined(DISABLE_SECURE_GETENV)
+    /*
+     * Use secure_getenv, unless the DISABLE_SECURE_GETENV is defined
+     * secure_getenv (when available) is used by default unless DISABLE_SECURE_GETENV is defined
+     * by the person building this library.
+     * See https://linux.die.net/man/3/secure_getenv for reasons to disable it.
+     */
+    return (secure_getenv(posixlycorrectenv) != NULL);
+#elif defined(HAVE___SECURE_GETENV) && !defined(DISABLE_SECURE_GETENV)
+    /*
+     * Use secure_getenv, unless the DISABLE_SECURE_GETENV is defined
+     * secure_getenv (when available) is used by default unless DISABLE_SECURE_GETENV is defined
+     * by the person building this library.
+     * See https://linux.die.net/man/3/secure_getenv for reasons to disable it.
+     */
+    return (__secure_getenv(posixlycorrectenv) != NULL);
+#else
+    return (getenv(posixlycorrectenv) != NULL);
+#endif
+}
 
-#if defined(NEED_PROGNAME)
-    /* store progam name before any other parsing is done */
-    getopt_progname = nargv[0];
-#endif // NEED_PROGNAME
+/*
+ * getopt_internal_r --
+ *	Parse argc/argv argument vector using the state in d.
+ */
+int getopt_internal_r(int                    nargc,
+                      char* const*           nargv,
+                      const char*            options,
+                      const getoptLongTable* long_options,
+                      int*                   idx,
+                      int                    flags,
+                      struct getopt_context* d)
+{
+    const char* oli; /* option letter list index */
+    int         optchar, short_too, slash, state, cls;
 
     if (options == NULL)
         return (-1);
@@ -606,8 +1203,8 @@ static int getopt_internal(int                  nargc,
      * XXX Some GNU programs (like cvs) set optind to 0 instead of
      * XXX using optreset.  Work around this braindamage.
      */
-    if (optind == 0)
-        optind = optreset = 1;
+    if (d->optind == 0)
+        d->optind = d->optreset = 1;
 
     /*
      * Disable GNU extensions if POSIXLY_CORRECT is set or options
@@ -616,89 +1213,91 @@ static int getopt_internal(int                  nargc,
      * CV, 2009-12-14: Check POSIXLY_CORRECT anew if optind == 0 or
      *                 optreset != 0 for GNU compatibility.
      */
-    if (posixly_correct == -1 || optreset != 0)
+    if (d->posixly_correct == -1 || d->optreset != 0)
     {
-#if defined(HAVE_GETENV_S) || (defined(_WIN32) && defined(_MSC_VER) && defined(__STDC_SECURE_LIB__)) ||                \
-    (defined(__STDC_LIB_EXT1__) && defined(__STDC_WANT_LIB_EXT1__))
-        /* MSFT/C11 annex K adds getenv_s, so use it when available to check if this exists */
-        size_t size = 0;
-        if (getenv_s(&size, NULL, 0, posixlycorrectenv) == 0)
-        {
-            /*
-             * You can allocate a buffer based off of size and call it again to read it,
-             * however, this is not necessary. We just need to know if this exists or not
-             * since that is how to getenv line below was set to work before this _s function was added.
-             */
-            posixly_correct = 1;
-        }
-        else
-        {
-            posixly_correct = 0;
-        }
-#elif defined(HAVE_SECURE_GETENV) && !defined(DISABLE_SECURE_GETENV)
-        /*
-         * Use secure_getenv, unless the DISABLE_SECURE_GETENV is defined
-         * secure_getenv (when available) is used by default unless DISABLE_SECURE_GETENV is defined
-         * by the person building this library.
-         * See https://linux.die.net/man/3/secure_getenv for reasons to disable it.
-         */
-        posixly_correct = (secure_getenv(posixlycorrectenv) != NULL);
-#elif defined(HAVE___SECURE_GETENV) && !defined(DISABLE_SECURE_GETENV)
-        /*
-         * Use secure_getenv, unless the DISABLE_SECURE_GETENV is defined
-         * secure_getenv (when available) is used by default unless DISABLE_SECURE_GETENV is defined
-         * by the person building this library.
-         * See https://linux.die.net/man/3/secure_getenv for reasons to disable it.
-         */
-        posixly_correct = (__secure_getenv(posixlycorrectenv) != NULL);
-#else
-        posixly_correct = (getenv(posixlycorrectenv) != NULL);
-#endif
+        d->posixly_correct = getopt_posixly_correct();
     }
     if (*options == '-')
         flags |= FLAG_ALLARGS;
-    else if (posixly_correct || *options == '+')
+    else if (d->posixly_correct || *options == '+')
         flags &= ~FLAG_PERMUTE;
     if (*options == '+' || *options == '-')
         options++;
+    if (d->mode & GETOPT_MODE_SLASH)
+        flags |= FLAG_SLASH;
+    if (d->mode & GETOPT_MODE_NOCASE)
+        flags |= FLAG_NOCASE;
 
-    optarg = NULL;
-    if (optreset)
-        nonopt_start = nonopt_end = -1;
-start:
-    if (optreset || !*place)
-    { /* update scanning pointer */
-        optreset = 0;
-        if (optind >= nargc)
-        { /* end of argument vector */
-            place = (char*)(uintptr_t)EMSG;
-            if (nonopt_end != -1)
-            {
-                /* do permutation, if we have to */
-                permute_args(nonopt_start, nonopt_end, optind, nargv);
-                optind -= nonopt_end - nonopt_start;
+    d->optarg = NULL;
+    d->error  = GETOPT_ERROR_NONE;
+    if (d->optreset)
+        d->nonopt_start = d->nonopt_end = -1;
+    if (d->limits != NULL && d->limits->max_argc > 0 && nargc > d->limits->max_argc && d->optind < nargc)
+    {
+        /* refuse the whole vector without looking at it, and end the parse */
+        if (PRINT_ERROR)
+            getopt_warnx(GETOPT_ERR_MSG_ARGCLIMIT, nargc);
+        d->error        = GETOPT_ERROR_TOO_MANY_ARGS;
+        d->optopt       = 0;
+        d->optpos       = d->optind;
+        d->optind       = nargc;
+        d->optreset     = 0;
+        d->place        = (char*)(uintptr_t)EMSG;
+        d->nonopt_start = d->nonopt_end = -1;
+        return (BADCH);
+    }
+    if (d->place == NULL)
+        d->place = (char*)(uintptr_t)EMSG;
+    state = (d->optreset || !*d->place) ? SCAN_WORD : SCAN_OPTION;
+    while (state != SCAN_SHORT)
+    {
+        switch (state)
+        {
+        case SCAN_WORD: /* update scanning pointer */
+            d->optreset = 0;
+            if (d->optind >= nargc)
+            { /* end of argument vector */
+                d->place = (char*)(uintptr_t)EMSG;
+                if (d->nonopt_end != -1)
+                {
+                    /* do permutation, if we have to */
+                    permute_args(d->nonopt_start, d->nonopt_end, d->optind, nargv);
+                    d->optind -= d->nonopt_end - d->nonopt_start;
+                }
+                else if (d->nonopt_start != -1)
+                {
+                    /*
+                     * If we skipped non-options, set optind
+                     * to the first of them.
+                     */
+                    d->optind = d->nonopt_start;
+                }
+                d->nonopt_start = d->nonopt_end = -1;
+                return (-1);
             }
-            else if (nonopt_start != -1)
+            d->place = nargv[d->optind];
+            if (token_over_limit(d, d->place))
             {
-                /*
-                 * If we skipped non-options, set optind
-                 * to the first of them.
-                 */
-                optind = nonopt_start;
+                /* skipped like an option, so permutation stays consistent */
+                if (d->nonopt_start != -1 && d->nonopt_end == -1)
+                    d->nonopt_end = d->optind;
+                d->optpos = d->optind++;
+                optchar   = token_too_long(options, d->place, 0, d);
+                d->place  = (char*)(uintptr_t)EMSG;
+                return (optchar);
             }
-            nonopt_start = nonopt_end = -1;
-            return (-1);
-        }
-        if (*(place = nargv[optind]) != '-' || (place[1] == '\0' && strchr(options, '-') == NULL))
-        {
-            place = (char*)(uintptr_t)EMSG; /* found non-option */
+            state = scan_lead_state[getopt_char_class[(unsigned char)*d->place]];
+            break;
+
+        case SCAN_OPERAND:
+            d->place = (char*)(uintptr_t)EMSG; /* found non-option */
             if (flags & FLAG_ALLARGS)
             {
                 /*
                  * GNU extension:
                  * return non-option as argument to option 1
                  */
-                optarg = nargv[optind++];
+                d->optarg = nargv[d->optind++];
                 return (INORDER);
             }
             if (!(flags & FLAG_PERMUTE))
@@ -709,66 +1308,119 @@ start:
                  */
                 return (-1);
             }
+            if (flags & FLAG_INPLACE)
+            {
+                /*
+                 * Caller collects the non-options itself and
+                 * must not have argv reordered underneath it.
+                 */
+                d->optarg = nargv[d->optind++];
+                return (INORDER);
+            }
             /* do permutation */
-            if (nonopt_start == -1)
-                nonopt_start = optind;
-            else if (nonopt_end != -1)
+            if (d->nonopt_start == -1)
+                d->nonopt_start = d->optind;
+            else if (d->nonopt_end != -1)
             {
-                permute_args(nonopt_start, nonopt_end, optind, nargv);
-                nonopt_start = optind - (nonopt_end - nonopt_start);
-                nonopt_end   = -1;
+                permute_args(d->nonopt_start, d->nonopt_end, d->optind, nargv);
+                d->nonopt_start = d->optind - (d->nonopt_end - d->nonopt_start);
+                d->nonopt_end   = -1;
             }
-            optind++;
+            d->optind++;
             /* process next argument */
-            goto start;
-        }
-        if (nonopt_start != -1 && nonopt_end == -1)
-            nonopt_end = optind;
+            state = SCAN_WORD;
+            break;
+
+        case SCAN_DASH:
+            cls = getopt_char_class[(unsigned char)d->place[1]];
+            /* "-" is a non-option unless '-' is an option letter */
+            if (cls == CC_END && strchr(options, '-') == NULL)
+            {
+                state = SCAN_OPERAND;
+                break;
+            }
+            if (d->nonopt_start != -1 && d->nonopt_end == -1)
+                d->nonopt_end = d->optind;
+            /* "-" stays as is, anything longer skips its dash */
+            d->place += (cls != CC_END);
+            state = scan_dash_state[cls];
+            break;
+
+        case SCAN_DOUBLE:
+            /* d->place is at the second dash; if "--" we are done */
+            if (d->place[1] == '\0')
+            {
+                d->optind++;
+                d->place = (char*)(uintptr_t)EMSG;
+                /*
+                 * We found an option (--), so if we skipped
+                 * non-options, we have to permute.
+                 */
+                if (d->nonopt_end != -1)
+                {
+                    permute_args(d->nonopt_start, d->nonopt_end, d->optind, nargv);
+                    d->optind -= d->nonopt_end - d->nonopt_start;
+                }
+                d->nonopt_start = d->nonopt_end = -1;
+                return (-1);
+            }
+            state = SCAN_OPTION;
+            break;
+
+        case SCAN_SLASH:
+            slash = (flags & FLAG_SLASH) ? slash_option_kind(d->place, options, long_options, flags) : SLASH_NONE;
+            if (slash == SLASH_NONE)
+            {
+                state = SCAN_OPERAND;
+                break;
+            }
+            if (d->nonopt_start != -1 && d->nonopt_end == -1)
+                d->nonopt_end = d->optind;
+            return (parse_slash_option(nargc, nargv, options, long_options, idx, flags, slash, d));
+
+        case SCAN_OPTION:
+            d->optpos = d->optind;
+            state     = SCAN_SHORT;
 
-        /*
-         * If we have "-" do nothing, if "--" we are done.
-         */
-        if (place[1] != '\0' && *++place == '-' && place[1] == '\0')
-        {
-            optind++;
-            place = (char*)(uintptr_t)EMSG;
             /*
-             * We found an option (--), so if we skipped
-             * non-options, we have to permute.
+             * Check long options if:
+             *  1) we were passed some
+             *  2) the arg is not just "-"
+             *  3) either the arg starts with -- we are getopt_long_only()
              */
-            if (nonopt_end != -1)
+            if (long_options != NULL && d->place != nargv[d->optind] && (*d->place == '-' || (flags & FLAG_LONGONLY)))
             {
-                permute_args(nonopt_start, nonopt_end, optind, nargv);
-                optind -= nonopt_end - nonopt_start;
+                short_too = 0;
+                if (*d->place == '-')
+                    d->place++; /* --foo long option */
+                else if (*d->place != ':' && strchr(options, *d->place) != NULL)
+                    short_too = 1; /* could be short option too */
+
+                optchar = parse_long_options(nargv, options, long_options, idx, short_too, flags, d);
+                if (optchar != -1)
+                {
+                    d->place = (char*)(uintptr_t)EMSG;
+                    return (optchar);
+                }
             }
-            nonopt_start = nonopt_end = -1;
-            return (-1);
+            break;
         }
     }
 
-    /*
-     * Check long options if:
-     *  1) we were passed some
-     *  2) the arg is not just "-"
-     *  3) either the arg starts with -- we are getopt_long_only()
-     */
-    if (long_options != NULL && place != nargv[optind] && (*place == '-' || (flags & FLAG_LONGONLY)))
+    if (d->limits != NULL && d->limits->max_cluster > 0 &&
+        (size_t)(d->place - nargv[d->optind]) > d->limits->max_cluster)
     {
-        short_too = 0;
-        if (*place == '-')
-            place++; /* --foo long option */
-        else if (*place != ':' && strchr(options, *place) != NULL)
-            short_too = 1; /* could be short option too */
-
-        optchar = parse_long_options(nargv, options, long_options, idx, short_too, flags);
-        if (optchar != -1)
-        {
-            place = (char*)(uintptr_t)EMSG;
-            return (optchar);
-        }
+        /* too far into a "-abc" cluster: drop the rest of the word */
+        optchar = (int)*d->place;
+        if (PRINT_ERROR)
+            getopt_warnx(GETOPT_ERR_MSG_CLUSTERLIMIT, optchar);
+        d->error  = GETOPT_ERROR_CLUSTER_TOO_LONG;
+        d->optopt = optchar;
+        d->place  = (char*)(uintptr_t)EMSG;
+        ++d->optind;
+        return (BADCH);
     }
-
-    if ((optchar = (int)*place++) == (int)':' || (optchar == (int)'-' && *place != '\0') ||
+    if ((optchar = (int)*d->place++) == (int)':' || (optchar == (int)'-' && *d->place != '\0') ||
         (oli = strchr(options, optchar)) == NULL)
     {
         /*
@@ -776,64 +1428,185 @@ start:
          * options, return -1 (non-option) as per POSIX.
          * Otherwise, it is an unknown option character (or ':').
          */
-        if (optchar == (int)'-' && *place == '\0')
+        if (optchar == (int)'-' && *d->place == '\0')
             return (-1);
-        if (!*place)
-            ++optind;
+        if (!*d->place)
+            ++d->optind;
         if (PRINT_ERROR)
             getopt_warnx(GETOPT_ERR_MSG_ILLOPTCHAR, optchar);
-        optopt = optchar;
+        d->error  = GETOPT_ERROR_UNKNOWN_OPTION;
+        d->optopt = optchar;
         return (BADCH);
     }
     if (long_options != NULL && optchar == 'W' && oli[1] == ';')
     {
         /* -W long-option */
-        if (*place) /* no space */
+        if (*d->place) /* no space */
             /* NOTHING */;
-        else if (++optind >= nargc)
+        else if (++d->optind >= nargc)
         { /* no arg */
-            place = (char*)(uintptr_t)EMSG;
+            d->place = (char*)(uintptr_t)EMSG;
             if (PRINT_ERROR)
                 getopt_warnx(GETOPT_ERR_MSG_RECARGCHAR, optchar);
-            optopt = optchar;
+            d->error  = GETOPT_ERROR_MISSING_ARGUMENT;
+            d->optopt = optchar;
             return (BADARG);
         }
+        else if (token_over_limit(d, nargv[d->optind]))
+        { /* -W argument too long */
+            d->place = (char*)(uintptr_t)EMSG;
+            return (token_too_long(options, nargv[d->optind++], optchar, d));
+        }
         else /* white space */
-            place = nargv[optind];
-        optchar = parse_long_options(nargv, options, long_options, idx, 0, flags);
-        place   = (char*)(uintptr_t)EMSG;
+            d->place = nargv[d->optind];
+        optchar = parse_long_options(nargv, options, long_options, idx, 0, flags, d);
+        d->place   = (char*)(uintptr_t)EMSG;
         return (optchar);
     }
     if (*++oli != ':')
     { /* doesn't take argument */
-        if (!*place)
-            ++optind;
+        if (!*d->place)
+            ++d->optind;
     }
     else
     { /* takes (optional) argument */
-        optarg = NULL;
-        if (*place) /* no white space */
-            optarg = place;
+        d->optarg = NULL;
+        if (*d->place) /* no white space */
+            d->optarg = d->place;
         else if (oli[1] != ':')
         { /* arg not optional */
-            if (++optind >= nargc)
+            if (++d->optind >= nargc)
             { /* no arg */
-                place = (char*)(uintptr_t)EMSG;
+                d->place = (char*)(uintptr_t)EMSG;
                 if (PRINT_ERROR)
                     getopt_warnx(GETOPT_ERR_MSG_RECARGCHAR, optchar);
-                optopt = optchar;
+                d->error  = GETOPT_ERROR_MISSING_ARGUMENT;
+                d->optopt = optchar;
                 return (BADARG);
             }
+            else if (token_over_limit(d, nargv[d->optind]))
+            {
+                d->place = (char*)(uintptr_t)EMSG;
+                return (token_too_long(options, nargv[d->optind++], optchar, d));
+            }
             else
-                optarg = nargv[optind];
+                d->optarg = nargv[d->optind];
         }
-        place = (char*)(uintptr_t)EMSG;
-        ++optind;
+        d->place = (char*)(uintptr_t)EMSG;
+        ++d->optind;
     }
     /* dump back option letter */
     return (optchar);
 }
 
+/*
+ * Copy the optind/optarg/... globals into the global context and return it;
+ * getopt_global_store() copies them back out.
+ */
+struct getopt_context* getopt_global_load(char* const* nargv)
+{
+    struct getopt_context* d = &getopt_global_context;
+
+#if defined(NEED_PROGNAME)
+    /* store progam name before any other parsing is done */
+    getopt_progname = nargv[0];
+#else
+    (void)nargv;
+#endif // NEED_PROGNAME
+
+    d->optind   = optind;
+    d->opterr   = opterr;
+    d->optopt   = optopt;
+    d->optreset = optreset;
+    d->optarg   = optarg;
+    d->mode     = optmode;
+    return (d);
+}
+
+void getopt_global_store(const struct getopt_context* d)
+{
+    optind   = d->optind;
+    optopt   = d->optopt;
+    optreset = d->optreset;
+    optarg   = d->optarg;
+}
+
+/*
+ * getopt_internal --
+ *	Parse argc/argv argument vector using the global state.
+ */
+int getopt_internal(int                    nargc,
+                    char* const*           nargv,
+                    const char*            options,
+                    const getoptLongTable* long_options,
+                    int*                   idx,
+                    int                    flags)
+{
+    struct getopt_context* d = getopt_global_load(nargv);
+    int                    result;
+
+    result = getopt_internal_r(nargc, nargv, options, long_options, idx, flags, d);
+    getopt_global_store(d);
+    return (result);
+}
+
+/*
+ * Fill in table for whichever long option format is given and return it,
+ * or NULL when there are no long options at all.
+ */
+const getoptLongTable* getopt_longopt_table(getoptLongTable*              table,
+                                            const struct option*          options,
+                                            const struct packed_options*  packed,
+                                            const struct getopt_registry* registry)
+{
+    table->options  = options;
+    table->packed   = packed;
+    table->registry = registry;
+    return ((options != NULL || packed != NULL || registry != NULL) ? table : NULL);
+}
+
+/*
+ * Start a side effect free walk over argv for the APIs that look at a
+ * command line without consuming it: argv is not permuted, flag pointers
+ * are not written and, when quiet, nothing is printed. flags may add
+ * FLAG_LONGONLY.
+ */
+void getopt_scan_init(getoptScan*                  scan,
+                      struct getopt_context*       d,
+                      const char*                  options,
+                      const struct option*         long_options,
+                      const struct packed_options* packed,
+                      int                          flags,
+                      int                          quiet)
+{
+    scan->options      = options;
+    scan->long_options = getopt_longopt_table(&scan->table, long_options, packed, NULL);
+    scan->flags        = flags | FLAG_PERMUTE | FLAG_INPLACE | FLAG_NOSTORE;
+    scan->start        = d->optind;
+    scan->idx          = -1;
+    if (quiet)
+        d->opterr = 0;
+}
+
+/*
+ * One step of a scan. scan->start and scan->idx tell which word the
+ * result came from and which long option it was.
+ */
+int getopt_scan_next(getoptScan* scan, int nargc, char* const* nargv, struct getopt_context* d)
+{
+    scan->start = d->optind;
+    scan->idx   = -1;
+    return (getopt_internal_r(nargc, nargv, scan->options, scan->long_options, &scan->idx, scan->flags, d));
+}
+
+/*
+ * Whether the last step returned a non-option rather than an option.
+ */
+int getopt_scan_operand(const getoptScan* scan, int optchar, char* const* nargv, const struct getopt_context* d)
+{
+    return (optchar == INORDER && scan->idx == -1 && d->optarg == nargv[scan->start]);
+}
+
 #ifdef REPLACE_GETOPT
 /*
  * getopt --
@@ -862,8 +1635,14 @@ int getopt(int nargc, char* const* nargv, const char* options)
  */
 int getopt_long(int nargc, char* const* nargv, const char* options, const struct option* long_options, int* idx)
 {
+    getoptLongTable table;
 
-    return (getopt_internal(nargc, nargv, options, long_options, idx, FLAG_PERMUTE));
+    return (getopt_internal(nargc,
+                            nargv,
+                            options,
+                            getopt_longopt_table(&table, long_options, NULL, NULL),
+                            idx,
+                            FLAG_PERMUTE));
 }
 
 /*
@@ -872,6 +1651,65 @@ int getopt_long(int nargc, char* const* nargv, const char* options, const struct
  */
 int getopt_long_only(int nargc, char* const* nargv, const char* options, const struct option* long_options, int* idx)
 {
+    getoptLongTable table;
+
+    return (getopt_internal(nargc,
+                            nargv,
+                            options,
+                            getopt_longopt_table(&table, long_options, NULL, NULL),
+                            idx,
+                            FLAG_PERMUTE | FLAG_LONGONLY));
+}
+
+/*
+ * getopt_r --
+ *	Parse argc/argv argument vector using the state in ctx.
+ */
+int getopt_r(int nargc, char* const* nargv, const char* options, struct getopt_context* ctx)
+{
+    return (getopt_internal_r(nargc, nargv, options, NULL, NULL, 0, ctx));
+}
+
+/*
+ * getopt_long_r --
+ *	Parse argc/argv argument vector using the state in ctx.
+ */
+int getopt_long_r(int                    nargc,
+                  char* const*           nargv,
+                  const char*            options,
+                  const struct option*   long_options,
+                  int*                   idx,
+                  struct getopt_context* ctx)
+{
+    getoptLongTable table;
+
+    return (getopt_internal_r(nargc,
+                              nargv,
+                              options,
+                              getopt_longopt_table(&table, long_options, NULL, NULL),
+                              idx,
+                              FLAG_PERMUTE,
+                              ctx));
+}
+
+/*
+ * getopt_long_only_r --
+ *	Parse argc/argv argument vector using the state in ctx.
+ */
+int getopt_long_only_r(int                    nargc,
+                       char* const*           nargv,
+                       const char*            options,
+                       const struct option*   long_options,
+                       int*                   idx,
+                       struct getopt_context* ctx)
+{
+    getoptLongTable table;
 
-    return (getopt_internal(nargc, nargv, options, long_options, idx, FLAG_PERMUTE | FLAG_LONGONLY));
+    return (getopt_internal_r(nargc,
+                              nargv,
+                              options,
+                              getopt_longopt_table(&table, long_options, NULL, NULL),
+                              idx,
+                              FLAG_PERMUTE | FLAG_LONGONLY,
+                              ctx));
 }
@@ -106,6 +106,8 @@ extern "C"
 #if !defined(__UNISTD_H_SOURCED__) && !defined(__GETOPT_LONG_H__)
 #define __GETOPT_LONG_H__ // NOLINT
 
+#include <stddef.h> /* size_t */
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -136,6 +138,789 @@ extern "C"
                                 const char*          options,
                                 const struct option* long_options,
                                 int*                 idx);
+
+    enum getopt_error /* kind of error reported in getopt_context::error */
+    {
+        GETOPT_ERROR_NONE = 0,
+        GETOPT_ERROR_UNKNOWN_OPTION,      /* option not in options/long_options	*/
+        GETOPT_ERROR_AMBIGUOUS,           /* abbreviation of several long options	*/
+        GETOPT_ERROR_MISSING_ARGUMENT,    /* required argument not given		*/
+        GETOPT_ERROR_UNEXPECTED_ARGUMENT, /* --name=arg for a no_argument option	*/
+        GETOPT_ERROR_INVALID_VALUE,       /* bound argument failed to convert	*/
+        GETOPT_ERROR_NO_SPACE,            /* no room left for a bound list item	*/
+        GETOPT_ERROR_UNKNOWN_COMMAND,     /* word matches no subcommand		*/
+        GETOPT_ERROR_TOO_MANY_ARGS,       /* argc over getopt_limits::max_argc	*/
+        GETOPT_ERROR_TOKEN_TOO_LONG,      /* word over getopt_limits::max_token	*/
+        GETOPT_ERROR_CLUSTER_TOO_LONG,    /* "-abc" over getopt_limits::max_cluster */
+        GETOPT_ERROR_EXPANSION_TOO_LARGE, /* sources over max_expansion words	*/
+        GETOPT_ERROR_CONFLICT,            /* option conflicts with one in effect	*/
+        GETOPT_ERROR_INVALID_SPEC         /* the spec itself is unusable		*/
+    };
+
+    /*
+     * Bounds for parsing untrusted input, each 0 for no limit. With limits
+     * set, the parser reads no argv entry past max_argc and no byte past
+     * max_token + 1 of a word, so the work per call is bounded.
+     *
+     * max_argc: an argc above this fails the first call with
+     * GETOPT_ERROR_TOO_MANY_ARGS and ends the parse (optind is set to argc).
+     * max_token: a word, or an option argument taken from the next word,
+     * longer than this many bytes is skipped with GETOPT_ERROR_TOKEN_TOO_LONG.
+     * SIZE_MAX, like 0, is no limit.
+     * max_cluster: the option character at this many + 1 bytes into a "-abc"
+     * cluster fails with GETOPT_ERROR_CLUSTER_TOO_LONG and the rest of the
+     * word is skipped.
+     * max_expansion: the most words getopt_reload_apply() accepts from all
+     * its sources together (not counting each argv[0]); more fail with
+     * GETOPT_ERROR_EXPANSION_TOO_LARGE before anything is parsed.
+     */
+    struct getopt_limits
+    {
+        int    max_argc;      /* largest argc accepted			*/
+        size_t max_token;     /* longest word, in bytes			*/
+        size_t max_cluster;   /* most option characters in one word	*/
+        size_t max_expansion; /* most words from all reload sources	*/
+    };
+
+    /*
+     * Parser state for the reentrant getopt_r() family. The first five fields
+     * have the same meaning as the globals of the same name, error tells why
+     * the last call returned '?' or ':', optpos is the argv index (at the
+     * time of the call) of the token the returned option came from and mode
+     * selects the optional syntax extensions below. limits, if not NULL,
+     * bounds the input (see struct getopt_limits); the rest is
+     * private to the parser. Initialise with GETOPT_CONTEXT_INIT, or set
+     * optind to 0 to restart a parse with an existing context.
+     */
+    struct getopt_context
+    {
+        int                         optind;   /* index of first non-option in argv	*/
+        int                         opterr;   /* enable built-in diagnostics		*/
+        int                         optopt;   /* single option character, as parsed	*/
+        int                         optreset; /* reset parsing				*/
+        char*                       optarg;   /* argument of current option		*/
+        int                         error;    /* enum getopt_error for the last call	*/
+        int                         optpos;   /* argv index of the last option's token	*/
+        int                         mode;     /* GETOPT_MODE_* bits			*/
+        const struct getopt_limits* limits;   /* input limits, or NULL			*/
+        char*                       place;    /* option letter processing		*/
+        int                         nonopt_start;
+        int                         nonopt_end;
+        int                         posixly_correct;
+    };
+
+#define GETOPT_CONTEXT_INIT {1, 1, '?', 0, NULL, GETOPT_ERROR_NONE, 0, 0, NULL, NULL, -1, -1, -1}
+
+    /*
+     * Bits for getopt_context::mode, and for the optmode global used by
+     * getopt(), getopt_long() and getopt_long_only().
+     *
+     * GETOPT_MODE_SLASH: also accept Windows style options. "/name" is
+     * matched as "--name" would be and "/x" as "-x" when no long option is
+     * called exactly "x". An argument may follow ':' or '=' ("/out:file",
+     * "/o=file") or, when required, come in the next word. There is no
+     * clustering. A word starting with '/' is an option only if the part
+     * before any ':' or '=' is not empty, contains no further '/' and names
+     * an option (a long option, an abbreviation of one, or a short option
+     * character). Anything else, such as "/usr/bin" or "/tmp" in a program
+     * without a "tmp" option, is an operand. Paths that could collide with
+     * an option name should be passed as "./x" or after "--".
+     *
+     * GETOPT_MODE_NOCASE: match long option names (and registry namespaces)
+     * without regard to ASCII case, so "--Verbose" and "/OUT" find
+     * "verbose" and "out". Only 'A'-'Z' fold; the locale is not consulted.
+     * Abbreviation and ambiguity rules are unchanged, and short options
+     * stay case sensitive. See getopt_pack_fold() for packed tables.
+     */
+#define GETOPT_MODE_SLASH  0x01
+#define GETOPT_MODE_NOCASE 0x02
+
+    WINGETOPT_API extern int optmode; /* GETOPT_MODE_* bits for the global API */
+
+    extern int getopt_r(int nargc, char* const* nargv, const char* options, struct getopt_context* ctx);
+    extern int getopt_long_r(int                    nargc,
+                             char* const*           nargv,
+                             const char*            options,
+                             const struct option*   long_options,
+                             int*                   idx,
+                             struct getopt_context* ctx);
+    extern int getopt_long_only_r(int                    nargc,
+                                  char* const*           nargv,
+                                  const char*            options,
+                                  const struct option*   long_options,
+                                  int*                   idx,
+                                  struct getopt_context* ctx);
+
+    /*
+     * Write a canonical form of argv to out so it can be forwarded to another
+     * program without it having to resolve abbreviations again: long options
+     * by full name with any argument attached as --name=arg, short option
+     * clusters split into one -x per option with a required argument as the
+     * following token, and operands after a "--" terminator (operands stay in
+     * place when options begins with '-'). Tokens that are already canonical,
+     * and option arguments, point into nargv; anything else is built in buf.
+     * out receives argv[0] first and is NULL terminated.
+     * Flag pointers in long_options are not written. ctx may be NULL; on a
+     * parse error it holds the optind/optopt of the failing option.
+     * With getopt_long_only_canonical, a short option whose -x form would be
+     * read back as a long option keeps the word it was given in, if it began
+     * that word; inside a cluster it fails with EINVAL.
+     * Returns the number of tokens written to out, or -1 with errno set to
+     * EINVAL for a parse error or ERANGE when out or buf is too small.
+     */
+    extern int getopt_long_canonical(int                    nargc,
+                                     char* const*           nargv,
+                                     const char*            options,
+                                     const struct option*   long_options,
+                                     char**                 out,
+                                     int                    out_count,
+                                     char*                  buf,
+                                     size_t                 buf_size,
+                                     struct getopt_context* ctx);
+    extern int getopt_long_only_canonical(int                    nargc,
+                                          char* const*           nargv,
+                                          const char*            options,
+                                          const struct option*   long_options,
+                                          char**                 out,
+                                          int                    out_count,
+                                          char*                  buf,
+                                          size_t                 buf_size,
+                                          struct getopt_context* ctx);
+
+    /*
+     * An option specification shared between many parses, and one argument
+     * vector to check against it. limits bounds the input accepted by
+     * getopt_validate*(), the getopt_query_*() index, the C++ parser and,
+     * unless replaced after init, getopt_reload_apply(); the other users of
+     * a spec ignore it.
+     */
+    struct getopt_spec
+    {
+        const char*                 options;      /* short options, as for getopt_long	*/
+        const struct option*        long_options; /* may be NULL			*/
+        int                         long_only;    /* match as getopt_long_only		*/
+        const struct getopt_limits* limits;       /* may be NULL for no limits	*/
+    };
+
+    struct getopt_argv
+    {
+        int          argc;
+        char* const* argv;
+    };
+
+    struct getopt_verdict
+    {
+        int error;  /* enum getopt_error, GETOPT_ERROR_NONE if valid	*/
+        int index;  /* argv index of the offending token, or -1	*/
+        int optopt; /* optopt for the offending option		*/
+    };
+
+    /*
+     * Check an argument vector against spec without any side effects: argv is
+     * not permuted, flag pointers are not written, nothing is printed and no
+     * global state is read or written other than the POSIXLY_CORRECT
+     * environment variable. Returns 0 if argv is valid, else -1 with the reason
+     * in verdict. Safe to call from several threads at once.
+     */
+    extern int getopt_validate(const struct getopt_spec* spec,
+                               int                       nargc,
+                               char* const*              nargv,
+                               struct getopt_verdict*    verdict);
+
+    /*
+     * Validate count argument vectors against one spec, writing one verdict
+     * per vector. Returns the number of invalid vectors, or 0 with errno set
+     * to EINVAL if spec, vectors or verdicts is NULL; nothing is checked then.
+     */
+    extern size_t getopt_validate_batch(const struct getopt_spec*  spec,
+                                        const struct getopt_argv*  vectors,
+                                        struct getopt_verdict*     verdicts,
+                                        size_t                     count);
+
+    /*
+     * As getopt_validate_batch, for vectors[first] up to but not including
+     * vectors[last] only. Calls on disjoint ranges of one batch may run on
+     * different threads at once. first > last is EINVAL, as above.
+     */
+    extern size_t getopt_validate_range(const struct getopt_spec*  spec,
+                                        const struct getopt_argv*  vectors,
+                                        struct getopt_verdict*     verdicts,
+                                        size_t                     first,
+                                        size_t                     last);
+
+    /*
+     * As getopt_validate_batch, split into contiguous chunks checked on up to
+     * threads threads, the calling thread included. Only a build with
+     * GETOPT_THREADS defined starts threads (pthreads, or Win32 threads on
+     * Windows); otherwise, or when a thread cannot be started, the work is
+     * done on the calling thread and the verdicts are the same.
+     */
+    extern size_t getopt_validate_batch_parallel(const struct getopt_spec*  spec,
+                                                 const struct getopt_argv*  vectors,
+                                                 struct getopt_verdict*     verdicts,
+                                                 size_t                     count,
+                                                 unsigned                   threads);
+
+    /*
+     * Lazy query interface for programs that only need to look at one or two
+     * options. The first query parses argv once, with the same rules as
+     * getopt_long()/getopt_long_only() but without permuting argv, writing
+     * flags or printing, and records every option occurrence. Later queries
+     * are answered from that index. An option is identified by the value
+     * getopt_long would return for it, so a long option whose val is 'o'
+     * matches queries for 'o' and vice versa.
+     * If argv contains an error, the index stops there and error/error_index
+     * describe it; queries still see the occurrences before it.
+     */
+    struct getopt_query_entry
+    {
+        int   value;      /* what getopt_long returned for it	*/
+        int   long_index; /* index into long_options, or -1	*/
+        int   index;      /* argv index of the option token	*/
+        char* arg;        /* its argument, or NULL		*/
+    };
+
+    struct getopt_query
+    {
+        struct getopt_spec         spec;
+        int                        argc;
+        char* const*               argv;
+        struct getopt_query_entry* entries;     /* built on first query	*/
+        int                        count;       /* number of entries	*/
+        int                        capacity;    /* allocated entries	*/
+        int                        built;       /* index is ready	*/
+        int                        error;       /* enum getopt_error	*/
+        int                        error_index; /* argv index of error	*/
+    };
+
+    extern void getopt_query_init(struct getopt_query*      query,
+                                  const struct getopt_spec* spec,
+                                  int                       nargc,
+                                  char* const*              nargv);
+    extern void getopt_query_free(struct getopt_query* query);
+
+    /*
+     * Return the number of occurrences of the option, or -1 if the index could
+     * not be built (errno set).
+     */
+    extern int getopt_query_has(struct getopt_query* query, const char* name);
+    extern int getopt_query_has_short(struct getopt_query* query, int optchar);
+
+    /*
+     * Return the argument of the last occurrence of the option, or NULL if it
+     * was not given or given without an argument.
+     */
+    extern const char* getopt_query_arg(struct getopt_query* query, int optchar);
+    extern const char* getopt_query_arg_long(struct getopt_query* query, const char* name);
+
+    /*
+     * Declarative binding of options to the fields of a caller's struct.
+     * Each binding names the option by the value getopt_long returns for it
+     * (the short option character, or val for a long option without a flag)
+     * and the field by offsetof(). getopt_long_bind() stores bound options as
+     * it scans and only returns options without a binding, errors and -1.
+     *
+     *   kind                  field type              stored
+     *   GETOPT_BIND_BOOL      int                     1
+     *   GETOPT_BIND_COUNTER   int                     incremented
+     *   GETOPT_BIND_INT       int                     strtol(optarg), base 0
+     *   GETOPT_BIND_SIZE      size_t                  strtoull(optarg), base 0,
+     *                                                 optional k/m/g suffix
+     *   GETOPT_BIND_STRING    const char*             optarg (points into argv)
+     *   GETOPT_BIND_LIST      struct getopt_bind_list optarg appended
+     *
+     * A value kind whose optional argument was left out keeps its field
+     * unchanged. List items point into argv. A list starts with whatever
+     * storage the caller put in it; once that is full it grows inside the
+     * arena, doubling each time, and fails with GETOPT_ERROR_NO_SPACE when
+     * there is no arena or it is exhausted.
+     */
+    enum getopt_bind_kind
+    {
+        GETOPT_BIND_END = 0, /* terminates a binding table */
+        GETOPT_BIND_BOOL,
+        GETOPT_BIND_COUNTER,
+        GETOPT_BIND_INT,
+        GETOPT_BIND_SIZE,
+        GETOPT_BIND_STRING,
+        GETOPT_BIND_LIST
+    };
+
+    struct getopt_binding
+    {
+        int    value;  /* what getopt_long returns for the option	*/
+        int    kind;   /* enum getopt_bind_kind			*/
+        size_t offset; /* offsetof() of the field in the target	*/
+    };
+
+    struct getopt_bind_list
+    {
+        const char** items;    /* collected arguments			*/
+        size_t       count;    /* number of items			*/
+        size_t       capacity; /* room in items				*/
+    };
+
+    struct getopt_arena
+    {
+        char*  base; /* caller supplied storage		*/
+        size_t size; /* bytes at base				*/
+        size_t used; /* bytes handed out so far		*/
+    };
+
+    struct getopt_binder
+    {
+        const struct getopt_binding* bindings; /* ends with GETOPT_BIND_END	*/
+        void*                        target;   /* struct the offsets refer to	*/
+        struct getopt_arena*         arena;    /* list storage, or NULL		*/
+    };
+
+    /*
+     * Like getopt_long_r() (or getopt_long_only_r() when spec->long_only is
+     * set), storing bound options into binder->target. With a NULL ctx the
+     * global optind/optarg/... state is used, as with getopt_long().
+     */
+    extern int getopt_long_bind(int                         nargc,
+                                char* const*                nargv,
+                                const struct getopt_spec*   spec,
+                                const struct getopt_binder* binder,
+                                int*                        idx,
+                                struct getopt_context*      ctx);
+
+    /*
+     * Options that imply, override or conflict with others, for example
+     *
+     *   {OPT_FAST,  GETOPT_DERIVE_IMPLIES,   OPT_NO_VERIFY, NULL},
+     *   {OPT_FAST,  GETOPT_DERIVE_IMPLIES,   't',           "8"},
+     *   {'q',       GETOPT_DERIVE_OVERRIDES, 'v',           NULL},
+     *   {OPT_FAST,  GETOPT_DERIVE_CONFLICTS, OPT_VERIFY,    NULL},
+     *   {0,         GETOPT_DERIVE_END,       0,             NULL}
+     *
+     * Options are named by value as in struct getopt_binding. An implied
+     * option is stored through its binding as if it had been given with arg,
+     * and what it implies follows, transitively. An overridden option has its
+     * field reset to 0, NULL or an empty list. A conflict is symmetric, and
+     * fails when either option takes effect while the other is in effect,
+     * whether given or implied, and not overridden since.
+     *
+     * getopt_closure_init() resolves the bindings and flattens each option's
+     * rules into one list, in declaration order with implications expanded
+     * depth first. getopt_long_derive() then applies that list after each
+     * option, so later options win, as they do on the command line. Implied
+     * and overridden options must be bound, and an implied option cannot be
+     * a GETOPT_BIND_LIST. init also converts each implied arg once and
+     * rejects one its binding would refuse, so applying a closure never
+     * stops half way. An option that would conflict with itself or with
+     * something it implies is rejected at init as well.
+     */
+    enum getopt_derive_kind
+    {
+        GETOPT_DERIVE_END = 0, /* terminates a rule table */
+        GETOPT_DERIVE_IMPLIES,
+        GETOPT_DERIVE_OVERRIDES,
+        GETOPT_DERIVE_CONFLICTS
+    };
+
+    struct getopt_derivation
+    {
+        int         value;  /* option the rule belongs to		*/
+        int         kind;   /* enum getopt_derive_kind		*/
+        int         target; /* option it implies, overrides or conflicts with */
+        const char* arg;    /* argument for an implied option, or NULL */
+    };
+
+    struct getopt_closure_step
+    {
+        int         kind; /* enum getopt_derive_kind		*/
+        int         node; /* index of the target in nodes	*/
+        const char* arg;  /* argument for GETOPT_DERIVE_IMPLIES	*/
+    };
+
+    struct getopt_closure_node
+    {
+        int                          value;   /* option value, nodes are sorted by it */
+        const struct getopt_binding* binding; /* its binding, or NULL		*/
+        int                          first;   /* its closure in steps, conflicts first */
+        int                          count;   /* steps in its closure		*/
+    };
+
+    struct getopt_closure
+    {
+        const struct getopt_binder* binder;     /* where options are stored	*/
+        struct getopt_closure_node* nodes;      /* bound or named in a rule	*/
+        int                         node_count;
+        struct getopt_closure_step* steps;      /* every node's closure	*/
+        int                         step_count;
+        unsigned char*              active;     /* per node, in effect in this parse */
+    };
+
+    /*
+     * init returns 0, or -1 with errno set to EINVAL or ENOMEM. The binder
+     * must stay valid while the closure is used. A closure tracks one parse
+     * at a time; call getopt_closure_reset() before starting another.
+     */
+    extern int  getopt_closure_init(struct getopt_closure*          closure,
+                                    const struct getopt_binder*     binder,
+                                    const struct getopt_derivation* rules);
+    extern void getopt_closure_reset(struct getopt_closure* closure);
+    extern void getopt_closure_free(struct getopt_closure* closure);
+
+    /*
+     * Like getopt_long_bind() with closure->binder, applying each option's
+     * closure as it is parsed. An option without a binding is still returned,
+     * after its closure has been applied. A conflict returns '?' with
+     * GETOPT_ERROR_CONFLICT and optopt set to the option given, and stores
+     * nothing for it.
+     */
+    extern int getopt_long_derive(int                       nargc,
+                                  char* const*              nargv,
+                                  const struct getopt_spec* spec,
+                                  struct getopt_closure*    closure,
+                                  int*                      idx,
+                                  struct getopt_context*    ctx);
+
+    /*
+     * Subcommand dispatch for "tool [global opts] cmd [cmd opts] args" style
+     * programs. Each node of the command tree has its own spec; a node with
+     * subcommands stops at its first non-option and resolves it as the name
+     * of a subcommand (exactly, or by unique prefix), then carries on with
+     * that subcommand's spec from the next word. The whole command line is
+     * parsed in one pass with one context, so no optreset is needed between
+     * levels. A leaf permutes its operands like getopt_long() unless its
+     * options begin with '+'.
+     */
+    struct getopt_command
+    {
+        const char*                  name;        /* NULL ends a subcommand array	*/
+        struct getopt_spec           spec;        /* options of this command	*/
+        const struct getopt_command* subcommands; /* NULL for a leaf command	*/
+    };
+
+#define GETOPT_COMMAND_MAX_DEPTH 8
+
+    struct getopt_command_state
+    {
+        struct getopt_context        ctx;
+        const struct getopt_command* path[GETOPT_COMMAND_MAX_DEPTH]; /* root first	*/
+        int                          depth;  /* commands in path		*/
+        int                          failed; /* a command name was rejected	*/
+    };
+
+#define GETOPT_COMMAND_STATE_INIT {GETOPT_CONTEXT_INIT, {NULL}, 0, 0}
+
+    /*
+     * Return the next option of the command line, as getopt_long_r() would.
+     * The option belongs to state->path[state->depth - 1]. At the end (-1)
+     * path holds the selected command path and state->ctx.optind the first
+     * operand. An unknown or ambiguous command name returns '?' with
+     * state->ctx.error set. A command tree deeper than
+     * GETOPT_COMMAND_MAX_DEPTH, or a subcommand without spec.options, is a
+     * mistake in the program rather than in its input: it returns '?' with
+     * GETOPT_ERROR_INVALID_SPEC and errno set to EINVAL and prints nothing.
+     * A rejected command name ends the parse, since the words after it have
+     * no command to be parsed by: state->ctx.optind is left at the name and
+     * every later call returns -1 until the state is reinitialised.
+     */
+    extern int getopt_command_next(int                          nargc,
+                                   char* const*                 nargv,
+                                   const struct getopt_command* root,
+                                   int*                         idx,
+                                   struct getopt_command_state* state);
+
+    /*
+     * Packed alternative to a struct option[] table for memory constrained
+     * builds. All names live in one contiguous string pool (not NUL terminated)
+     * addressed by a 16-bit offset, has_arg is kept in two bits of info and the
+     * flag pointer is replaced by a small index into a table of flag slots.
+     * Slot 0 means "no flag"; slot n refers to flag_slots[n - 1].
+     */
+    struct packed_option
+    {
+        unsigned short name_off; /* offset of the name in the string pool	*/
+        unsigned char  name_len; /* length of the name			*/
+        unsigned char  info;     /* has_arg and flag slot, see below	*/
+        int            val;      /* its associated status value		*/
+    };
+
+#define PACKED_OPTION_INFO(has_arg, slot) ((unsigned char)(((slot) << 2) | ((has_arg)&0x03)))
+#define PACKED_OPTION_HAS_ARG(info)       ((int)((info)&0x03))
+#define PACKED_OPTION_FLAG_SLOT(info)     ((int)((info) >> 2))
+#define PACKED_OPTION_MAX_NAME_LEN        255
+#define PACKED_OPTION_MAX_POOL_SIZE       65535
+#define PACKED_OPTION_MAX_FLAG_SLOTS      63
+
+    struct packed_options
+    {
+        const struct packed_option* options;    /* table entries, in order	*/
+        int                         count;      /* number of entries		*/
+        const char*                 pool;       /* concatenated option names	*/
+        int* const*                 flag_slots; /* targets for info flag slots	*/
+        const char*                 folded;     /* pool in lower case, or NULL	*/
+    };
+
+    /*
+     * Compute the buffer sizes getopt_pack_options() needs for long_options.
+     * Any of the output pointers may be NULL.
+     */
+    extern int getopt_pack_options_size(const struct option* long_options,
+                                        size_t*              entry_count,
+                                        size_t*              pool_size,
+                                        size_t*              flag_slot_count);
+
+    /*
+     * Convert a NULL terminated struct option[] into a packed table using
+     * caller supplied storage. Returns 0 on success or -1 with errno set to
+     * ERANGE when a buffer is too small or a limit above is exceeded.
+     * The packed table does not reference long_options after conversion.
+     */
+    extern int getopt_pack_options(const struct option*   long_options,
+                                   struct packed_option*  entries,
+                                   size_t                 max_entries,
+                                   char*                  pool,
+                                   size_t                 pool_size,
+                                   int**                  flag_slots,
+                                   size_t                 max_flag_slots,
+                                   struct packed_options* table);
+
+    /*
+     * Fold the names of a packed table to lower case once, into folded,
+     * which needs as many bytes as the string pool. GETOPT_MODE_NOCASE
+     * then only has to fold the argument. Returns 0, or -1 with errno set
+     * to ERANGE if size is too small.
+     */
+    extern int getopt_pack_fold(struct packed_options* table, char* folded, size_t size);
+
+    extern int getopt_long_packed(int                          nargc,
+                                  char* const*                 nargv,
+                                  const char*                  options,
+                                  const struct packed_options* long_options,
+                                  int*                         idx);
+    extern int getopt_long_only_packed(int                          nargc,
+                                       char* const*                 nargv,
+                                       const char*                  options,
+                                       const struct packed_options* long_options,
+                                       int*                         idx);
+
+    /*
+     * Diagnostics handler. When set, every message getopt would print
+     * (opterr set and options not starting with ':') is passed to handler
+     * instead: the error code, the option character (or 0) and the option
+     * name or argument the message is about (or NULL), which is not NUL
+     * terminated. Set it before parsing; it is shared by all contexts.
+     *
+     * The library can be built with less diagnostics support, for small
+     * static and UEFI binaries. Parsing is the same in every build:
+     *   default                      stderr, or handler if one is set
+     *   GETOPT_DIAGNOSTIC_CALLBACK   handler only; no stdio, no program name
+     *   DISABLE_GETOPT_DIAGNOSTICS   nothing is reported; handler is ignored
+     */
+    typedef void (*getopt_diagnostic_fn)(void*       user,
+                                         int         error,
+                                         int         optopt,
+                                         const char* name,
+                                         size_t      name_len);
+
+    extern void getopt_set_diagnostic_handler(getopt_diagnostic_fn handler, void* user);
+
+    /*
+     * Registry of long option tables contributed at run time, for example by
+     * plugins. Each table is registered under a namespace prefix and names
+     * its options without it; "--cache.size" is option "size" of the table
+     * registered as "cache". A table registered under "" holds options
+     * without a namespace. Matching gives the same result as one table with
+     * every option renamed to "prefix.name", the options without a namespace
+     * first and then the namespaces in prefix order, so abbreviations and
+     * ambiguity work across namespaces as they would in that table ("--ca"
+     * abbreviates every option of "cache"). A name containing the separator
+     * is only looked up in its own namespace, found by binary search.
+     * Registering or removing a table only moves namespace entries; tables
+     * are not copied and must outlive their registration.
+     *
+     * For getopt_long_registry() *idx holds the namespace (its index in
+     * registry->spaces) and the option index in that namespace's table, or
+     * -1 when the call did not return a registered option: a short option,
+     * an error or the end of the options.
+     */
+#define GETOPT_NAMESPACE_SEPARATOR      '.'
+#define GETOPT_REGISTRY_NAMESPACE(idx)  ((idx) >> 16)
+#define GETOPT_REGISTRY_OPTION(idx)     ((idx)&0xFFFF)
+#define GETOPT_REGISTRY_MAX_OPTIONS     0xFFFF
+#define GETOPT_REGISTRY_MAX_NAMESPACES  0x7FFF
+
+    struct getopt_namespace
+    {
+        const char*          prefix;     /* without the separator		*/
+        size_t               prefix_len; /* strlen(prefix)			*/
+        const struct option* options;    /* names without the prefix	*/
+    };
+
+    struct getopt_registry
+    {
+        struct getopt_namespace* spaces;   /* sorted by prefix		*/
+        int                      count;    /* registered namespaces	*/
+        int                      capacity; /* allocated namespaces	*/
+    };
+
+#define GETOPT_REGISTRY_INIT {NULL, 0, 0}
+
+    /*
+     * Return 0, or -1 with errno set: EINVAL for a prefix containing the
+     * separator or '=' or a table with more than GETOPT_REGISTRY_MAX_OPTIONS
+     * options, EEXIST if the prefix is taken, ENOENT if it is not registered
+     * (remove), ENOSPC past GETOPT_REGISTRY_MAX_NAMESPACES, ENOMEM.
+     */
+    extern int  getopt_registry_add(struct getopt_registry* registry,
+                                    const char*             prefix,
+                                    const struct option*    long_options);
+    extern int  getopt_registry_remove(struct getopt_registry* registry, const char* prefix);
+    extern void getopt_registry_free(struct getopt_registry* registry);
+
+    extern int getopt_long_registry(int                           nargc,
+                                    char* const*                  nargv,
+                                    const char*                   options,
+                                    const struct getopt_registry* registry,
+                                    int*                          idx);
+    extern int getopt_long_only_registry(int                           nargc,
+                                         char* const*                  nargv,
+                                         const char*                   options,
+                                         const struct getopt_registry* registry,
+                                         int*                          idx);
+
+    /*
+     * Incremental parsing for editors that re-check a command line on every
+     * change. getopt_incremental_init() classifies every word of argv by the
+     * rules of getopt_long()/getopt_long_only(), without permuting argv,
+     * writing flags or printing, and keeps going past errors. After words
+     * [first, first + removed) were replaced by inserted new words,
+     * getopt_incremental_update() re-classifies only the words whose meaning
+     * can have changed. It restarts at the option that owns the word before
+     * the edit and stops at the first word after the edit that begins a
+     * parse step as it did before. The tokens then match a fresh
+     * getopt_incremental_init() over the new argv.
+     */
+    enum getopt_token_kind
+    {
+        GETOPT_TOKEN_PROGRAM = 0, /* argv[0]					*/
+        GETOPT_TOKEN_OPTION,      /* one or more options			*/
+        GETOPT_TOKEN_ARGUMENT,    /* separate argument of the option at owner	*/
+        GETOPT_TOKEN_OPERAND,     /* non-option					*/
+        GETOPT_TOKEN_TERMINATOR,  /* "--"					*/
+        GETOPT_TOKEN_REST         /* operand after option parsing stopped	*/
+    };
+
+    struct getopt_token
+    {
+        int kind;       /* enum getopt_token_kind			*/
+        int owner;      /* argv index of the word its parse step began at */
+        int value;      /* what getopt_long returned for its last option */
+        int long_index; /* index into long_options, or -1		*/
+        int options;    /* number of options in the word		*/
+        int error;      /* enum getopt_error of its first bad option	*/
+        int optopt;     /* optopt of that error			*/
+    };
+
+    struct getopt_incremental
+    {
+        struct getopt_spec   spec;
+        int                  argc;
+        char* const*         argv;
+        struct getopt_token* tokens;          /* one per argv word		*/
+        int                  capacity;        /* allocated tokens		*/
+        int                  posixly_correct; /* POSIXLY_CORRECT, looked up once */
+    };
+
+    /*
+     * Return 0, or -1 with errno set to EINVAL or ENOMEM. argv is kept by
+     * reference; pass the edited vector to each update.
+     */
+    extern int  getopt_incremental_init(struct getopt_incremental* inc,
+                                        const struct getopt_spec*  spec,
+                                        int                        nargc,
+                                        char* const*               nargv);
+    extern int  getopt_incremental_update(struct getopt_incremental* inc,
+                                          int                        nargc,
+                                          char* const*               nargv,
+                                          int                        first,
+                                          int                        removed,
+                                          int                        inserted);
+    extern void getopt_incremental_free(struct getopt_incremental* inc);
+
+    /*
+     * Reloading option sources in a long running program. The long option
+     * table is packed once by getopt_reload_init(). Each getopt_reload_apply()
+     * then parses a new set of argument vectors (for example the command
+     * line and an options file, each with a placeholder argv[0]). It uses
+     * the rules of getopt_long()/getopt_long_only(), without permuting argv,
+     * writing flags or printing, and reports only what differs from the last
+     * successful apply. An option is identified by the value getopt_long
+     * returns for it, or by its long_options index if it sets a flag. The
+     * n-th occurrence of an option is compared with its previous n-th
+     * occurrence. Operands are reported as occurrences of value 1, as with
+     * a leading '-' in options. Arguments are copied, so the sources may be
+     * freed once apply returns. If a source has an error, the previous
+     * state is kept and verdict/error_source say where. init takes limits
+     * from the spec; set them after init to bound apply differently.
+     */
+    enum getopt_change_kind
+    {
+        GETOPT_CHANGE_ADDED = 1, /* new occurrence; old_arg is NULL		*/
+        GETOPT_CHANGE_REMOVED,   /* occurrence gone; new_arg is NULL		*/
+        GETOPT_CHANGE_CHANGED    /* same occurrence, different argument	*/
+    };
+
+    struct getopt_change
+    {
+        int         kind;       /* enum getopt_change_kind		*/
+        int         value;      /* what getopt_long returned for it	*/
+        int         long_index; /* index into long_options, or -1	*/
+        int         occurrence; /* 0 for the first occurrence		*/
+        const char* old_arg;    /* previous argument, or NULL		*/
+        const char* new_arg;    /* new argument, or NULL		*/
+    };
+
+    struct getopt_reload_entry
+    {
+        int    value;      /* what getopt_long returned for it	*/
+        int    long_index; /* index into long_options, or -1	*/
+        int    occurrence; /* ordinal among equal options		*/
+        int    sequence;   /* position in the parse			*/
+        size_t arg;        /* offset of the argument copy, or (size_t)-1 */
+    };
+
+    struct getopt_reload_state
+    {
+        struct getopt_reload_entry* entries;  /* sorted by option, then occurrence */
+        int                         count;    /* number of entries		*/
+        int                         capacity; /* allocated entries		*/
+        char*                       strings;  /* argument copies		*/
+        size_t                      used;     /* bytes used in strings	*/
+        size_t                      size;     /* bytes allocated		*/
+    };
+
+    struct getopt_reload
+    {
+        struct getopt_spec          spec;
+        struct packed_options       table;        /* spec->long_options, packed once */
+        void*                       table_memory; /* storage behind table	*/
+        struct getopt_reload_state  current;      /* last successful apply	*/
+        struct getopt_reload_state  previous;     /* the one before it	*/
+        struct getopt_change*       changes;      /* result of the last apply	*/
+        int                         change_count;
+        int                         change_capacity;
+        struct getopt_verdict       verdict;      /* why the last apply failed	*/
+        int                         error_source; /* index of that source, or -1 */
+        const struct getopt_limits* limits;       /* applied to each source, or NULL */
+    };
+
+    /*
+     * init returns 0, or -1 with errno set to EINVAL or ENOMEM. apply returns
+     * the number of changes in reload->changes, valid until the next apply,
+     * or -1 with errno set to EINVAL or ENOMEM, or to 0 for a parse error.
+     */
+    extern int  getopt_reload_init(struct getopt_reload* reload, const struct getopt_spec* spec);
+    extern int  getopt_reload_apply(struct getopt_reload*     reload,
+                                    const struct getopt_argv* sources,
+                                    size_t                    count);
+    extern void getopt_reload_free(struct getopt_reload* reload);
 /*
  * Previous MinGW implementation had...
  */
@@ -0,0 +1,291 @@
+/* SPDX-License-Identifier: BSD-2-Clause  */
+/* Modifications Copyright 2022 Seagate Technology and/or its Affiliates */
+
+/*
+ * C++ range interface over the reentrant getopt_long_r() family.
+ *
+ *   struct getopt_spec spec = {"vo:", long_options, 0, NULL};
+ *   auto args = wingetopt::parse(argc, argv, spec);
+ *   for (auto&& opt : args)
+ *   {
+ *       if (opt.error != wingetopt::error_kind::none) ...
+ *       switch (opt.id) { case 'o': out = opt.arg; break; ... }
+ *   }
+ *   for (std::string_view operand : args.operands()) ...
+ *
+ * Parsing happens in getopt.c; this header only drives it. Nothing is
+ * allocated and no global state is used, so several parses may run at once.
+ * As with getopt_long(), operands are permuted to the end of argv.
+ * Requires C++17 for std::string_view.
+ */
+
+#ifndef __GETOPT_HPP__
+#define __GETOPT_HPP__ // NOLINT
+
+#include <getopt.h>
+
+#include <cstddef>
+#include <iterator>
+#include <string_view>
+
+namespace wingetopt
+{
+    enum class error_kind
+    {
+        none                = GETOPT_ERROR_NONE,
+        unknown_option      = GETOPT_ERROR_UNKNOWN_OPTION,
+        ambiguous           = GETOPT_ERROR_AMBIGUOUS,
+        missing_argument    = GETOPT_ERROR_MISSING_ARGUMENT,
+        unexpected_argument = GETOPT_ERROR_UNEXPECTED_ARGUMENT,
+        invalid_value       = GETOPT_ERROR_INVALID_VALUE,
+        no_space            = GETOPT_ERROR_NO_SPACE,
+        unknown_command     = GETOPT_ERROR_UNKNOWN_COMMAND,
+        too_many_args       = GETOPT_ERROR_TOO_MANY_ARGS,
+        token_too_long      = GETOPT_ERROR_TOKEN_TOO_LONG,
+        cluster_too_long    = GETOPT_ERROR_CLUSTER_TOO_LONG,
+        expansion_too_large = GETOPT_ERROR_EXPANSION_TOO_LARGE,
+        conflict            = GETOPT_ERROR_CONFLICT,
+        invalid_spec        = GETOPT_ERROR_INVALID_SPEC
+    };
+
+    /* One option as returned by the parser. */
+    struct parsed_option
+    {
+        int              id;         /* value getopt_long_r() returned	*/
+        std::string_view arg;        /* its argument, empty if none	*/
+        bool             has_arg;    /* an argument was given		*/
+        int              index;      /* argv index of the option token	*/
+        int              long_index; /* index into long_options, or -1	*/
+        error_kind       error;      /* why id is '?' or ':'		*/
+    };
+
+    /* The operands left in argv once parsing is done. */
+    class operand_view
+    {
+      public:
+        class iterator
+        {
+          public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type        = std::string_view;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = void;
+            using reference         = std::string_view;
+
+            constexpr iterator() noexcept = default;
+            constexpr explicit iterator(char* const* pos) noexcept : m_pos(pos) {}
+
+            std::string_view operator*() const noexcept { return std::string_view(*m_pos); }
+            std::string_view operator[](difference_type n) const noexcept { return std::string_view(m_pos[n]); }
+            iterator&        operator++() noexcept
+            {
+                ++m_pos;
+                return *this;
+            }
+            iterator operator++(int) noexcept
+            {
+                iterator old = *this;
+                ++m_pos;
+                return old;
+            }
+            iterator& operator--() noexcept
+            {
+                --m_pos;
+                return *this;
+            }
+            iterator operator--(int) noexcept
+            {
+                iterator old = *this;
+                --m_pos;
+                return old;
+            }
+            iterator& operator+=(difference_type n) noexcept
+            {
+                m_pos += n;
+                return *this;
+            }
+            iterator& operator-=(difference_type n) noexcept
+            {
+                m_pos -= n;
+                return *this;
+            }
+            friend iterator operator+(iterator it, difference_type n) noexcept { return it += n; }
+            friend iterator operator+(difference_type n, iterator it) noexcept { return it += n; }
+            friend iterator operator-(iterator it, difference_type n) noexcept { return it -= n; }
+            friend difference_type operator-(iterator a, iterator b) noexcept { return a.m_pos - b.m_pos; }
+            friend bool            operator==(iterator a, iterator b) noexcept { return a.m_pos == b.m_pos; }
+            friend bool            operator!=(iterator a, iterator b) noexcept { return a.m_pos != b.m_pos; }
+            friend bool            operator<(iterator a, iterator b) noexcept { return a.m_pos < b.m_pos; }
+            friend bool            operator>(iterator a, iterator b) noexcept { return a.m_pos > b.m_pos; }
+            friend bool            operator<=(iterator a, iterator b) noexcept { return a.m_pos <= b.m_pos; }
+            friend bool            operator>=(iterator a, iterator b) noexcept { return a.m_pos >= b.m_pos; }
+
+          private:
+            char* const* m_pos = nullptr;
+        };
+
+        constexpr operand_view() noexcept = default;
+        constexpr operand_view(char* const* first, char* const* last) noexcept : m_first(first), m_last(last) {}
+
+        iterator         begin() const noexcept { return iterator(m_first); }
+        iterator         end() const noexcept { return iterator(m_last); }
+        std::size_t      size() const noexcept { return static_cast<std::size_t>(m_last - m_first); }
+        bool             empty() const noexcept { return m_first == m_last; }
+        std::string_view operator[](std::size_t n) const noexcept { return std::string_view(m_first[n]); }
+
+      private:
+        char* const* m_first = nullptr;
+        char* const* m_last  = nullptr;
+    };
+
+    /*
+     * A single pass over argv. Move-only, since two copies would share argv
+     * and fight over its permutation. Iterators refer to the parser that made
+     * them; moving a parser leaves the source empty, so those iterators are at
+     * end() and it yields no options and no operands.
+     */
+    class parser
+    {
+      public:
+        class sentinel
+        {
+        };
+
+        class iterator
+        {
+          public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type        = parsed_option;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = const parsed_option*;
+            using reference         = const parsed_option&;
+
+            iterator() noexcept = default;
+            explicit iterator(parser* owner) noexcept : m_owner(owner) {}
+
+            reference operator*() const noexcept { return m_owner->m_current; }
+            pointer   operator->() const noexcept { return &m_owner->m_current; }
+            iterator& operator++() noexcept
+            {
+                m_owner->next();
+                return *this;
+            }
+            void operator++(int) noexcept { m_owner->next(); }
+            bool at_end() const noexcept { return m_owner->m_done; }
+
+            friend bool operator==(const iterator& it, sentinel) noexcept { return it.at_end(); }
+            friend bool operator!=(const iterator& it, sentinel) noexcept { return !it.at_end(); }
+            friend bool operator==(sentinel, const iterator& it) noexcept { return it.at_end(); }
+            friend bool operator!=(sentinel, const iterator& it) noexcept { return !it.at_end(); }
+
+          private:
+            parser* m_owner = nullptr;
+        };
+
+        parser(int argc, char* const* argv, const getopt_spec& spec) noexcept
+            : m_argc(argc), m_argv(argv), m_spec(spec), m_context GETOPT_CONTEXT_INIT
+        {
+            m_context.opterr = 0;
+            m_context.limits = spec.limits;
+        }
+
+        parser(const parser&)            = delete;
+        parser& operator=(const parser&) = delete;
+
+        parser(parser&& other) noexcept
+            : m_argc(other.m_argc), m_argv(other.m_argv), m_spec(other.m_spec), m_context(other.m_context),
+              m_current(other.m_current), m_started(other.m_started), m_done(other.m_done)
+        {
+            other.clear();
+        }
+
+        parser& operator=(parser&& other) noexcept
+        {
+            if (this != &other)
+            {
+                m_argc    = other.m_argc;
+                m_argv    = other.m_argv;
+                m_spec    = other.m_spec;
+                m_context = other.m_context;
+                m_current = other.m_current;
+                m_started = other.m_started;
+                m_done    = other.m_done;
+                other.clear();
+            }
+            return *this;
+        }
+
+        /* Enable the built-in diagnostics on stderr (off by default). */
+        parser& print_errors(bool enable) noexcept
+        {
+            m_context.opterr = enable ? 1 : 0;
+            return *this;
+        }
+
+        /* Starts parsing; call once. */
+        iterator begin() noexcept
+        {
+            if (!m_started)
+            {
+                m_started = true;
+                next();
+            }
+            return iterator(this);
+        }
+        sentinel end() const noexcept { return sentinel(); }
+
+        /* Operands in argv; complete once iteration has reached end(). */
+        operand_view operands() const noexcept
+        {
+            int first = m_context.optind < m_argc ? m_context.optind : m_argc;
+            return operand_view(m_argv + first, m_argv + m_argc);
+        }
+
+        const getopt_context& context() const noexcept { return m_context; }
+
+      private:
+        /* Leaves nothing to parse, for a parser that has been moved from. */
+        void clear() noexcept
+        {
+            m_argc    = 0;
+            m_argv    = nullptr;
+            m_current = parsed_option{};
+            m_started = true;
+            m_done    = true;
+        }
+
+        void next() noexcept
+        {
+            int idx = -1;
+            int id  = m_spec.long_only
+                          ? getopt_long_only_r(m_argc, m_argv, m_spec.options, m_spec.long_options, &idx, &m_context)
+                          : getopt_long_r(m_argc, m_argv, m_spec.options, m_spec.long_options, &idx, &m_context);
+            if (id == -1)
+            {
+                m_done = true;
+                return;
+            }
+            m_current.id         = id;
+            m_current.has_arg    = m_context.optarg != nullptr;
+            m_current.arg        = m_current.has_arg ? std::string_view(m_context.optarg) : std::string_view();
+            m_current.index      = m_context.optpos;
+            m_current.long_index = idx;
+            m_current.error      = static_cast<error_kind>(m_context.error);
+        }
+
+        int            m_argc;
+        char* const*   m_argv;
+        getopt_spec    m_spec;
+        getopt_context m_context;
+        parsed_option  m_current{};
+        bool           m_started = false;
+        bool           m_done    = false;
+    };
+
+    inline parser parse(int argc, char* const* argv, const getopt_spec& spec) noexcept
+    {
+        return parser(argc, argv, spec);
+    }
+} // namespace wingetopt
+
+#endif /* !defined(__GETOPT_HPP__) */
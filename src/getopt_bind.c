@@ -0,0 +1,607 @@
+/* SPDX-License-Identifier: 0BSD AND BSD-2-Clause */
+/* Modifications Copyright 2022 Seagate Technology and/or its Affiliates */
+
+/*
+ * getopt_long_bind() and getopt_long_derive(): store parsed options into
+ * caller structures through binding tables and implication rules.
+ */
+
+#include "getopt_internal.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Hand out size bytes of pointer aligned storage from an arena.
+ */
+static void* getopt_arena_alloc(struct getopt_arena* arena, size_t size)
+{
+    size_t pad;
+
+    if (arena == NULL || arena->base == NULL || arena->used > arena->size)
+        return (NULL);
+    pad = (sizeof(void*) - ((uintptr_t)(arena->base + arena->used) % sizeof(void*))) % sizeof(void*);
+    if (pad > arena->size - arena->used || size > arena->size - arena->used - pad)
+        return (NULL);
+    arena->used += pad;
+    arena->used += size;
+    return (arena->base + arena->used - size);
+}
+
+/*
+ * Append item to a bound list, growing it in the arena when it is full.
+ * A list that was the last thing allocated from the arena grows in place.
+ */
+static int bind_list_append(struct getopt_bind_list* list, const char* item, struct getopt_arena* arena)
+{
+    if (list->count >= list->capacity)
+    {
+        size_t       capacity = list->capacity ? list->capacity * 2 : 8;
+        const char** items;
+
+        if (arena == NULL || capacity > ((size_t)-1) / sizeof(char*))
+            return (-1);
+        if (list->items != NULL && arena->base != NULL &&
+            (const char*)(list->items + list->capacity) == arena->base + arena->used &&
+            (capacity - list->capacity) * sizeof(char*) <= arena->size - arena->used)
+        {
+            arena->used += (capacity - list->capacity) * sizeof(char*);
+            items = list->items;
+        }
+        else if ((items = getopt_arena_alloc(arena, capacity * sizeof(char*))) == NULL)
+            return (-1);
+        else if (list->count > 0)
+            memcpy((void*)items, (const void*)list->items, list->count * sizeof(char*));
+        list->items    = items;
+        list->capacity = capacity;
+    }
+    list->items[list->count++] = item;
+    return (0);
+}
+
+/*
+ * Convert a GETOPT_BIND_SIZE argument. Accepts a k, m or g suffix for
+ * binary multiples.
+ */
+static int bind_parse_size(const char* arg, size_t* value)
+{
+    unsigned long long number;
+    char*              end;
+    int                shift = 0;
+
+    while (*arg == ' ' || *arg == '\t')
+        arg++;
+    if (*arg == '-' || *arg == '\0')
+        return (-1);
+    errno  = 0;
+    number = strtoull(arg, &end, 0);
+    if (errno != 0 || end == arg)
+        return (-1);
+    switch (*end)
+    {
+    case 'k':
+    case 'K':
+        shift = 10;
+        end++;
+        break;
+    case 'm':
+    case 'M':
+        shift = 20;
+        end++;
+        break;
+    case 'g':
+    case 'G':
+        shift = 30;
+        end++;
+        break;
+    default:
+        break;
+    }
+    if (*end != '\0' || number > (((unsigned long long)((size_t)-1)) >> shift))
+        return (-1);
+    *value = (size_t)(number << shift);
+    return (0);
+}
+
+/*
+ * Convert a GETOPT_BIND_INT argument.
+ */
+static int bind_parse_int(const char* arg, int* value)
+{
+    long  number;
+    char* end;
+
+    errno  = 0;
+    number = strtol(arg, &end, 0);
+    if (errno != 0 || end == arg || *end != '\0' || number < INT_MIN || number > INT_MAX)
+        return (-1);
+    *value = (int)number;
+    return (0);
+}
+
+/*
+ * Store one occurrence of a bound option. Returns GETOPT_ERROR_NONE or the
+ * reason it could not be stored.
+ */
+static int bind_store(const struct getopt_binding* binding,
+                      const struct getopt_binder*  binder,
+                      char*                        arg)
+{
+    char* field = (char*)binder->target + binding->offset;
+
+    switch (binding->kind)
+    {
+    case GETOPT_BIND_BOOL:
+        *(int*)(void*)field = 1;
+        return (GETOPT_ERROR_NONE);
+    case GETOPT_BIND_COUNTER:
+        if (*(int*)(void*)field < INT_MAX)
+            (*(int*)(void*)field)++;
+        return (GETOPT_ERROR_NONE);
+    default:
+        break;
+    }
+    if (arg == NULL)
+        return (GETOPT_ERROR_NONE); /* optional argument left out */
+    switch (binding->kind)
+    {
+    case GETOPT_BIND_INT:
+        if (bind_parse_int(arg, (int*)(void*)field) != 0)
+            return (GETOPT_ERROR_INVALID_VALUE);
+        break;
+    case GETOPT_BIND_SIZE:
+        if (bind_parse_size(arg, (size_t*)(void*)field) != 0)
+            return (GETOPT_ERROR_INVALID_VALUE);
+        break;
+    case GETOPT_BIND_STRING:
+        *(const char**)(void*)field = arg;
+        break;
+    case GETOPT_BIND_LIST:
+        if (bind_list_append((struct getopt_bind_list*)(void*)field, arg, binder->arena) != 0)
+            return (GETOPT_ERROR_NO_SPACE);
+        break;
+    default:
+        break;
+    }
+    return (GETOPT_ERROR_NONE);
+}
+
+/*
+ * The first binding for an option value, or NULL.
+ */
+static const struct getopt_binding* bind_find(const struct getopt_binder* binder, int value)
+{
+    const struct getopt_binding* binding;
+
+    for (binding = binder->bindings; binding != NULL && binding->kind != GETOPT_BIND_END; binding++)
+    {
+        if (binding->value == value)
+            return (binding);
+    }
+    return (NULL);
+}
+
+static int closure_find(const struct getopt_closure* closure, int value);
+static int closure_apply(struct getopt_closure* closure, int node, char* arg);
+
+/*
+ * Parse with getopt_internal_r, storing bound options and, with a closure,
+ * applying what each option implies or overrides. Returns options without
+ * a binding, errors and -1.
+ */
+static int getopt_bind_internal(int                         nargc,
+                                char* const*                nargv,
+                                const struct getopt_spec*   spec,
+                                const struct getopt_binder* binder,
+                                struct getopt_closure*      closure,
+                                int*                        idx,
+                                struct getopt_context*      ctx)
+{
+    struct getopt_context*       d = ctx ? ctx : getopt_global_load(nargv);
+    getoptLongTable              table;
+    const getoptLongTable*       long_options = getopt_longopt_table(&table, spec->long_options, NULL, NULL);
+    int                          flags        = FLAG_PERMUTE | (spec->long_only ? FLAG_LONGONLY : 0);
+    const struct getopt_binding* binding;
+    const char*                  options = spec->options;
+    int                          optchar, error, node;
+
+    for (;;)
+    {
+        optchar = getopt_internal_r(nargc, nargv, options, long_options, idx, flags, d);
+        if (optchar == -1 || d->error != GETOPT_ERROR_NONE || binder == NULL ||
+            (closure == NULL && binder->bindings == NULL))
+            break;
+        if (closure != NULL)
+        {
+            if ((node = closure_find(closure, optchar)) == -1)
+                break; /* neither bound nor named by a rule */
+            binding = closure->nodes[node].binding;
+            error   = closure_apply(closure, node, d->optarg);
+        }
+        else
+        {
+            if ((binding = bind_find(binder, optchar)) == NULL)
+                break; /* not bound, hand it to the caller */
+            error = bind_store(binding, binder, d->optarg);
+        }
+        if (error != GETOPT_ERROR_NONE)
+        {
+            /* PRINT_ERROR and BADARG look past a leading '+' or '-' */
+            if (*options == '+' || *options == '-')
+                options++;
+            if (PRINT_ERROR)
+            {
+                if (error == GETOPT_ERROR_CONFLICT)
+                    getopt_warnx(GETOPT_ERR_MSG_CONFLICT, nargv[d->optpos]);
+                else
+                    getopt_warnx(error == GETOPT_ERROR_NO_SPACE ? GETOPT_ERR_MSG_NOSPACE : GETOPT_ERR_MSG_BADVALUE,
+                                 d->optarg);
+            }
+            d->error  = error;
+            d->optopt = optchar;
+            optchar   = error == GETOPT_ERROR_CONFLICT ? BADCH : BADARG;
+            break;
+        }
+        if (binding == NULL)
+            break; /* not bound, hand it to the caller */
+    }
+    if (ctx == NULL)
+        getopt_global_store(d);
+    return (optchar);
+}
+
+/*
+ * getopt_long_bind --
+ *	Parse argc/argv argument vector, storing bound options into a struct.
+ */
+int getopt_long_bind(int                         nargc,
+                     char* const*                nargv,
+                     const struct getopt_spec*   spec,
+                     const struct getopt_binder* binder,
+                     int*                        idx,
+                     struct getopt_context*      ctx)
+{
+    return (getopt_bind_internal(nargc, nargv, spec, binder, NULL, idx, ctx));
+}
+
+/*
+ * Reset the field of an overridden option.
+ */
+static void bind_reset(const struct getopt_binding* binding, const struct getopt_binder* binder)
+{
+    char* field = (char*)binder->target + binding->offset;
+
+    switch (binding->kind)
+    {
+    case GETOPT_BIND_BOOL:
+    case GETOPT_BIND_COUNTER:
+    case GETOPT_BIND_INT:
+        *(int*)(void*)field = 0;
+        break;
+    case GETOPT_BIND_SIZE:
+        *(size_t*)(void*)field = 0;
+        break;
+    case GETOPT_BIND_STRING:
+        *(const char**)(void*)field = NULL;
+        break;
+    case GETOPT_BIND_LIST:
+        ((struct getopt_bind_list*)(void*)field)->count = 0;
+        break;
+    default:
+        break;
+    }
+}
+
+static int closure_value_compare(const void* a, const void* b)
+{
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+
+    return (x < y ? -1 : (x > y ? 1 : 0));
+}
+
+/*
+ * Index of the closure node for an option value, or -1.
+ */
+static int closure_find(const struct getopt_closure* closure, int value)
+{
+    int lo = 0, hi = closure->node_count, mid;
+
+    while (lo < hi)
+    {
+        mid = lo + (hi - lo) / 2;
+        if (closure->nodes[mid].value < value)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return ((lo < closure->node_count && closure->nodes[lo].value == value) ? lo : -1);
+}
+
+static int closure_push(struct getopt_closure* closure, int* capacity, int kind, int node, const char* arg)
+{
+    struct getopt_closure_step* step;
+
+    if (closure->step_count == *capacity)
+    {
+        int grown = *capacity ? *capacity * 2 : 16;
+        step      = realloc(closure->steps, (size_t)grown * sizeof(struct getopt_closure_step));
+        if (step == NULL)
+            return (-1);
+        closure->steps = step;
+        *capacity      = grown;
+    }
+    step       = &closure->steps[closure->step_count++];
+    step->kind = kind;
+    step->node = node;
+    step->arg  = arg;
+    return (0);
+}
+
+/*
+ * Append the rules of node, following implications depth first, to the
+ * closure of root: either only its conflicts (both directions) or only its
+ * implications and overrides. seen marks the nodes expanded so far.
+ */
+static int closure_expand(struct getopt_closure*          closure,
+                          const struct getopt_derivation* rules,
+                          int                             root,
+                          int                             node,
+                          int                             conflicts,
+                          unsigned char*                  seen,
+                          int*                            capacity)
+{
+    const struct getopt_derivation* r;
+    int                             value = closure->nodes[node].value;
+    int                             target;
+
+    for (r = rules; r->kind != GETOPT_DERIVE_END; r++)
+    {
+        if (r->kind == GETOPT_DERIVE_CONFLICTS)
+        {
+            if (conflicts && (r->value == value || r->target == value) &&
+                closure_push(closure,
+                             capacity,
+                             GETOPT_DERIVE_CONFLICTS,
+                             closure_find(closure, r->value == value ? r->target : r->value),
+                             NULL) != 0)
+                return (-1);
+            continue;
+        }
+        if (r->value != value)
+            continue;
+        target = closure_find(closure, r->target);
+        if (r->kind == GETOPT_DERIVE_IMPLIES && target == root)
+            continue; /* a cycle back to the option given; it is already stored */
+        if (!conflicts && closure_push(closure, capacity, r->kind, target, r->arg) != 0)
+            return (-1);
+        if (r->kind == GETOPT_DERIVE_IMPLIES && !seen[target])
+        {
+            seen[target] = 1;
+            if (closure_expand(closure, rules, root, target, conflicts, seen, capacity) != 0)
+                return (-1);
+        }
+    }
+    return (0);
+}
+
+/*
+ * Whether storing arg for an implied option always succeeds. A list could
+ * run out of arena space, so it cannot be implied.
+ */
+static int closure_arg_valid(const struct getopt_binding* binding, const char* arg)
+{
+    int    number;
+    size_t size;
+
+    switch (binding->kind)
+    {
+    case GETOPT_BIND_INT:
+        return (arg == NULL || bind_parse_int(arg, &number) == 0);
+    case GETOPT_BIND_SIZE:
+        return (arg == NULL || bind_parse_size(arg, &size) == 0);
+    case GETOPT_BIND_LIST:
+        return (0);
+    default:
+        return (1);
+    }
+}
+
+/*
+ * getopt_closure_init --
+ *	Resolve bindings and flatten the derivation rules of every option.
+ */
+int getopt_closure_init(struct getopt_closure*          closure,
+                        const struct getopt_binder*     binder,
+                        const struct getopt_derivation* rules)
+{
+    const struct getopt_binding*    b;
+    const struct getopt_derivation* r;
+    struct getopt_closure_node*     node;
+    unsigned char*                  seen   = NULL;
+    int*                            values = NULL;
+    size_t                          max    = 0, n = 0, k;
+    int                             i, j, capacity = 0, conflicts_end, error = EINVAL;
+
+    if (closure == NULL || binder == NULL || rules == NULL)
+    {
+        errno = EINVAL;
+        return (-1);
+    }
+    memset(closure, 0, sizeof(struct getopt_closure));
+    closure->binder = binder;
+
+    /* every option bound or named by a rule gets one node */
+    for (b = binder->bindings; b != NULL && b->kind != GETOPT_BIND_END; b++)
+        max++;
+    for (r = rules; r->kind != GETOPT_DERIVE_END; r++)
+    {
+        if (r->kind < GETOPT_DERIVE_IMPLIES || r->kind > GETOPT_DERIVE_CONFLICTS)
+            goto fail;
+        max += 2;
+    }
+    if (max == 0)
+        return (0);
+    if (max > INT_MAX || (values = malloc(max * sizeof(int))) == NULL)
+        goto nomem;
+    for (b = binder->bindings; b != NULL && b->kind != GETOPT_BIND_END; b++)
+        values[n++] = b->value;
+    for (r = rules; r->kind != GETOPT_DERIVE_END; r++)
+    {
+        values[n++] = r->value;
+        values[n++] = r->target;
+    }
+    qsort(values, n, sizeof(int), closure_value_compare);
+    for (k = 1, j = 1; k < n; k++)
+    {
+        if (values[k] != values[j - 1])
+            values[j++] = values[k];
+    }
+    closure->node_count = j;
+    closure->nodes      = malloc((size_t)j * sizeof(struct getopt_closure_node));
+    closure->active     = calloc((size_t)j, 1);
+    seen                = malloc((size_t)j);
+    if (closure->nodes == NULL || closure->active == NULL || seen == NULL)
+        goto nomem;
+    for (i = 0; i < j; i++)
+    {
+        node          = &closure->nodes[i];
+        node->value   = values[i];
+        node->binding = NULL;
+        node->first   = 0;
+        node->count   = 0;
+        for (b = binder->bindings; b != NULL && b->kind != GETOPT_BIND_END; b++)
+        {
+            if (b->value == node->value)
+            {
+                node->binding = b;
+                break;
+            }
+        }
+    }
+
+    /* implied and overridden options are stored through their bindings */
+    for (r = rules; r->kind != GETOPT_DERIVE_END; r++)
+    {
+        if (r->kind != GETOPT_DERIVE_CONFLICTS && closure->nodes[closure_find(closure, r->target)].binding == NULL)
+            goto fail;
+        if (r->kind == GETOPT_DERIVE_IMPLIES &&
+            !closure_arg_valid(closure->nodes[closure_find(closure, r->target)].binding, r->arg))
+            goto fail;
+    }
+
+    for (i = 0; i < j; i++)
+    {
+        node        = &closure->nodes[i];
+        node->first = closure->step_count;
+        memset(seen, 0, (size_t)j);
+        seen[i] = 1;
+        if (closure_expand(closure, rules, i, i, 1, seen, &capacity) != 0)
+            goto nomem;
+        conflicts_end = closure->step_count;
+
+        /* seen now holds the option and all it implies; none may conflict */
+        for (k = (size_t)node->first; k < (size_t)conflicts_end; k++)
+        {
+            if (seen[closure->steps[k].node])
+                goto fail;
+        }
+        memset(seen, 0, (size_t)j);
+        seen[i] = 1;
+        if (closure_expand(closure, rules, i, i, 0, seen, &capacity) != 0)
+            goto nomem;
+        node->count = closure->step_count - node->first;
+    }
+    free(values);
+    free(seen);
+    return (0);
+
+nomem:
+    error = ENOMEM;
+fail:
+    free(values);
+    free(seen);
+    getopt_closure_free(closure);
+    errno = error;
+    return (-1);
+}
+
+/*
+ * getopt_closure_reset --
+ *	Forget which options are in effect, before starting another parse.
+ */
+void getopt_closure_reset(struct getopt_closure* closure)
+{
+    if (closure != NULL && closure->active != NULL)
+        memset(closure->active, 0, (size_t)closure->node_count);
+}
+
+/*
+ * getopt_closure_free --
+ *	Release the storage of a closure.
+ */
+void getopt_closure_free(struct getopt_closure* closure)
+{
+    if (closure != NULL)
+    {
+        free(closure->nodes);
+        free(closure->steps);
+        free(closure->active);
+        memset(closure, 0, sizeof(struct getopt_closure));
+    }
+}
+
+/*
+ * Apply the closure of one option given with arg. Conflicts come first in
+ * the closure, so nothing is stored for a conflicting option, and implied
+ * arguments were checked by getopt_closure_init(), so once the option itself
+ * is stored the rest cannot fail.
+ */
+static int closure_apply(struct getopt_closure* closure, int node, char* arg)
+{
+    const struct getopt_closure_node* n   = &closure->nodes[node];
+    const struct getopt_closure_step* step;
+    int                               end = n->first + n->count;
+    int                               i, error;
+
+    for (i = n->first; i < end && closure->steps[i].kind == GETOPT_DERIVE_CONFLICTS; i++)
+    {
+        if (closure->active[closure->steps[i].node])
+            return (GETOPT_ERROR_CONFLICT);
+    }
+    if (n->binding != NULL && (error = bind_store(n->binding, closure->binder, arg)) != GETOPT_ERROR_NONE)
+        return (error);
+    closure->active[node] = 1;
+    for (; i < end; i++)
+    {
+        step = &closure->steps[i];
+        if (step->kind == GETOPT_DERIVE_OVERRIDES)
+        {
+            bind_reset(closure->nodes[step->node].binding, closure->binder);
+            closure->active[step->node] = 0;
+        }
+        else
+        {
+            (void)bind_store(closure->nodes[step->node].binding, closure->binder, (char*)(uintptr_t)step->arg);
+            closure->active[step->node] = 1;
+        }
+    }
+    return (GETOPT_ERROR_NONE);
+}
+
+/*
+ * getopt_long_derive --
+ *	Parse argc/argv argument vector, storing bound options and applying
+ *	what each option implies or overrides.
+ */
+int getopt_long_derive(int                       nargc,
+                       char* const*              nargv,
+                       const struct getopt_spec* spec,
+                       struct getopt_closure*    closure,
+                       int*                      idx,
+                       struct getopt_context*    ctx)
+{
+    return (getopt_bind_internal(nargc, nargv, spec, closure ? closure->binder : NULL, closure, idx, ctx));
+}
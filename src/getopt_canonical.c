@@ -0,0 +1,279 @@
+/* SPDX-License-Identifier: 0BSD AND BSD-2-Clause */
+/* Modifications Copyright 2022 Seagate Technology and/or its Affiliates */
+
+/*
+ * getopt_long_canonical() and getopt_long_only_canonical(): rewrite an argument
+ * vector into one that parses the same with every option spelled out.
+ */
+
+#include "getopt_internal.h"
+
+#include <errno.h>
+#include <string.h>
+
+/*
+ * Output buffer used while building a canonical argv.
+ */
+typedef struct sGetoptCanonicalOut
+{
+    char** out;
+    int    count;     /* tokens written from the front of out */
+    int    operands;  /* operands parked at the back of out */
+    int    out_count;
+    char*  buf;
+    size_t buf_used;
+    size_t buf_size;
+} getoptCanonicalOut;
+
+static int canonical_push(getoptCanonicalOut* co, char* token)
+{
+    /* leave room for the "--" terminator and the trailing NULL */
+    if (co->count + co->operands + 2 > co->out_count)
+        return (-1);
+    co->out[co->count++] = token;
+    return (0);
+}
+
+static int canonical_push_operand(getoptCanonicalOut* co, char* token)
+{
+    if (co->count + co->operands + 2 > co->out_count)
+        return (-1);
+    co->operands++;
+    co->out[co->out_count - co->operands] = token;
+    return (0);
+}
+
+/*
+ * Nonzero if getopt_long_only() would read the word "-" spelling as a long
+ * option rather than as the short option spelling[0].
+ */
+static int canonical_long_claims(const getoptScan* scan, const struct getopt_context* d, const char* spelling)
+{
+    longoptMatch m;
+    int          flags = scan->flags;
+
+    if (scan->long_options == NULL)
+        return (0);
+    if (d->mode & GETOPT_MODE_NOCASE)
+        flags |= FLAG_NOCASE;
+    getopt_longopt_match(scan->long_options, spelling, strcspn(spelling, "="), 1, flags, &m);
+    return (m.index != -1);
+}
+
+/*
+ * Build prefix + name[0..name_len) + [sep] + arg in the scratch buffer and
+ * push it as the next token. arg may be NULL, sep may be '\0' for none.
+ */
+static int canonical_build(getoptCanonicalOut* co,
+                           const char*         prefix,
+                           const char*         name,
+                           size_t              name_len,
+                           char                sep,
+                           const char*         arg)
+{
+    size_t prefix_len = getopt_strlen(prefix);
+    size_t sep_len    = (arg && sep) ? 1 : 0;
+    size_t arg_len    = arg ? getopt_strlen(arg) : 0;
+    size_t len        = prefix_len + name_len + sep_len + arg_len + 1;
+    char*  token;
+
+    if (len > co->buf_size - co->buf_used)
+        return (-1);
+    token = co->buf + co->buf_used;
+    memcpy(token, prefix, prefix_len);
+    memcpy(token + prefix_len, name, name_len);
+    if (sep_len)
+        token[prefix_len + name_len] = sep;
+    if (arg_len)
+        memcpy(token + prefix_len + name_len + sep_len, arg, arg_len);
+    token[len - 1] = '\0';
+    co->buf_used += len;
+    return (canonical_push(co, token));
+}
+
+static int getopt_canonical_internal(int                    nargc,
+                                     char* const*           nargv,
+                                     const char*            options,
+                                     const struct option*   long_options,
+                                     char**                 out,
+                                     int                    out_count,
+                                     char*                  buf,
+                                     size_t                 buf_size,
+                                     struct getopt_context* ctx,
+                                     int                    flags)
+{
+    struct getopt_context local = GETOPT_CONTEXT_INIT;
+    getoptScan            scan;
+    getoptCanonicalOut    co   = {out, 0, 0, out_count, buf, 0, buf_size};
+    const char*           opts = options + (*options == '+' || *options == '-');
+    const char*           oli;
+    int                   in_place, optchar, idx, start, i, optional, err = 0;
+    char*                 token;
+    char                  name[2];
+
+    if (nargc < 1 || nargv == NULL || options == NULL || out == NULL || out_count < 1 || (buf == NULL && buf_size))
+    {
+        errno = EINVAL;
+        return (-1);
+    }
+    if (ctx == NULL)
+    {
+        local.opterr = opterr;
+        ctx          = &local;
+    }
+    in_place = (*options == '-');
+    if (canonical_push(&co, nargv[0]) != 0)
+        err = ERANGE;
+
+    getopt_scan_init(&scan, ctx, options, long_options, NULL, flags, 0);
+    while (!err)
+    {
+        optchar = getopt_scan_next(&scan, nargc, nargv, ctx);
+        if (optchar == -1)
+            break;
+        start = scan.start;
+        idx   = scan.idx;
+        token = nargv[start];
+        if (idx != -1)
+        {
+            /* long option, possibly given as an abbreviation or through -W */
+            const char* lname = long_options[idx].name;
+            size_t      len   = getopt_strlen(lname);
+            if (token[0] == '-' && token[1] == '-' && strncmp(token + 2, lname, len) == 0 &&
+                ((ctx->optarg == NULL && token[len + 2] == '\0') ||
+                 (ctx->optarg == token + len + 3 && token[len + 2] == '=')))
+            {
+                if (canonical_push(&co, token) != 0)
+                    err = ERANGE;
+            }
+            else if (canonical_build(&co, "--", lname, len, '=', ctx->optarg) != 0)
+                err = ERANGE;
+        }
+        else if (getopt_scan_operand(&scan, optchar, nargv, ctx))
+        {
+            /* operand */
+            if ((in_place ? canonical_push(&co, token) : canonical_push_operand(&co, token)) != 0)
+                err = ERANGE;
+        }
+        else if (optchar == BADCH || optchar == (int)':')
+            err = EINVAL;
+        else if (optchar == (int)'-')
+        {
+            /* '-' listed in options */
+            if (canonical_build(&co, "-", "", 0, '\0', NULL) != 0)
+                err = ERANGE;
+        }
+        else
+        {
+            name[0] = (char)optchar;
+            name[1] = '\0';
+            oli     = strchr(opts, optchar);
+            optional = (ctx->optarg != NULL && oli != NULL && oli[1] == ':' && oli[2] == ':');
+            if ((flags & FLAG_LONGONLY) && canonical_long_claims(&scan, ctx, optional ? ctx->optarg - 1 : name))
+            {
+                /*
+                 * The split spelling would read back as a long option. Keep
+                 * the original word if the option started it, which parsed
+                 * as this short option; inside a cluster there is no form
+                 * that does.
+                 */
+                if (token[0] == '-' && token[1] == name[0] && ctx->optarg == token + 2)
+                {
+                    if (canonical_push(&co, token) != 0)
+                        err = ERANGE;
+                }
+                else
+                    err = EINVAL;
+            }
+            else if (optional)
+            {
+                /* optional argument, which has to stay attached */
+                if (token[0] == '-' && token[1] == name[0] && ctx->optarg == token + 2)
+                {
+                    if (canonical_push(&co, token) != 0)
+                        err = ERANGE;
+                }
+                else if (canonical_build(&co, "-", name, 1, '\0', ctx->optarg) != 0)
+                    err = ERANGE;
+            }
+            else
+            {
+                if (token[0] == '-' && token[1] == name[0] && token[2] == '\0')
+                {
+                    if (canonical_push(&co, token) != 0)
+                        err = ERANGE;
+                }
+                else if (canonical_build(&co, "-", name, 1, '\0', NULL) != 0)
+                    err = ERANGE;
+                if (!err && ctx->optarg != NULL && canonical_push(&co, ctx->optarg) != 0)
+                    err = ERANGE;
+            }
+        }
+    }
+    if (err)
+    {
+        errno = err;
+        return (-1);
+    }
+
+    /* operands that follow a "--" or the first non-option in '+' mode */
+    for (i = ctx->optind; i < nargc; i++)
+    {
+        if (canonical_push_operand(&co, nargv[i]) != 0)
+        {
+            errno = ERANGE;
+            return (-1);
+        }
+    }
+    if (co.operands > 0)
+    {
+        char** parked = out + out_count - co.operands;
+        /* parked operands were stored back to front */
+        for (i = 0; i < co.operands / 2; i++)
+        {
+            token                         = parked[i];
+            parked[i]                     = parked[co.operands - 1 - i];
+            parked[co.operands - 1 - i]   = token;
+        }
+        out[co.count++] = (char*)(uintptr_t) "--";
+        memmove(out + co.count, parked, (size_t)co.operands * sizeof(char*));
+        co.count += co.operands;
+    }
+    out[co.count] = NULL;
+    return (co.count);
+}
+
+/*
+ * getopt_long_canonical --
+ *	Write a canonical form of the argc/argv argument vector to out.
+ */
+int getopt_long_canonical(int                    nargc,
+                          char* const*           nargv,
+                          const char*            options,
+                          const struct option*   long_options,
+                          char**                 out,
+                          int                    out_count,
+                          char*                  buf,
+                          size_t                 buf_size,
+                          struct getopt_context* ctx)
+{
+    return (getopt_canonical_internal(nargc, nargv, options, long_options, out, out_count, buf, buf_size, ctx, 0));
+}
+
+/*
+ * getopt_long_only_canonical --
+ *	Write a canonical form of the argc/argv argument vector to out.
+ */
+int getopt_long_only_canonical(int                    nargc,
+                               char* const*           nargv,
+                               const char*            options,
+                               const struct option*   long_options,
+                               char**                 out,
+                               int                    out_count,
+                               char*                  buf,
+                               size_t                 buf_size,
+                               struct getopt_context* ctx)
+{
+    return (getopt_canonical_internal(
+        nargc, nargv, options, long_options, out, out_count, buf, buf_size, ctx, FLAG_LONGONLY));
+}
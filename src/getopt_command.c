@@ -0,0 +1,118 @@
+/* SPDX-License-Identifier: 0BSD AND BSD-2-Clause */
+/* Modifications Copyright 2022 Seagate Technology and/or its Affiliates */
+
+/*
+ * getopt_command_next(): parse nested subcommands.
+ */
+
+#include "getopt_internal.h"
+
+#include <errno.h>
+#include <string.h>
+
+/*
+ * Resolve word against a subcommand array: an exact name, or else a prefix
+ * of exactly one name. Returns the command, or NULL with *ambiguous set
+ * when the prefix matched several.
+ */
+static const struct getopt_command* getopt_find_command(const struct getopt_command* commands,
+                                                        const char*                  word,
+                                                        int*                         ambiguous)
+{
+    const struct getopt_command* match = NULL;
+    size_t                       len   = getopt_strlen(word);
+
+    *ambiguous = 0;
+    if (len == 0)
+        return (NULL);
+    for (; commands->name != NULL; commands++)
+    {
+        if (strncmp(commands->name, word, len) != 0)
+            continue;
+        if (commands->name[len] == '\0')
+            return (commands); /* exact match */
+        if (match != NULL)
+            *ambiguous = 1;
+        match = commands;
+    }
+    return (*ambiguous ? NULL : match);
+}
+
+/*
+ * getopt_command_next --
+ *	Parse a command line made of nested subcommands.
+ */
+int getopt_command_next(int                          nargc,
+                        char* const*                 nargv,
+                        const struct getopt_command* root,
+                        int*                         idx,
+                        struct getopt_command_state* state)
+{
+    struct getopt_context*       d = &state->ctx;
+    const struct getopt_command* cmd;
+    const struct getopt_command* sub;
+    const char*                  options;
+    char*                        word;
+    int                          optchar, start, ambiguous;
+
+    if (root == NULL || root->spec.options == NULL || state->failed)
+        return (-1);
+    if (state->depth == 0)
+    {
+        state->path[0] = root;
+        state->depth   = 1;
+    }
+    for (;;)
+    {
+        getoptLongTable table;
+
+        cmd     = state->path[state->depth - 1];
+        start   = d->optind ? d->optind : 1; /* optind 0 restarts at 1 */
+        optchar = getopt_internal_r(nargc,
+                                    nargv,
+                                    cmd->spec.options,
+                                    getopt_longopt_table(&table, cmd->spec.long_options, NULL, NULL),
+                                    idx,
+                                    (cmd->subcommands ? 0 : FLAG_PERMUTE) | (cmd->spec.long_only ? FLAG_LONGONLY : 0),
+                                    d);
+        if (cmd->subcommands == NULL)
+            return (optchar);
+
+        /* a command level stops at its first non-option, which names the next command */
+        if (optchar == INORDER && d->optarg == nargv[start] && d->optind == start + 1)
+            word = d->optarg; /* options began with '-' */
+        else if (optchar == -1 && d->optind == start && start < nargc)
+            word = nargv[start];
+        else
+            return (optchar);
+
+        sub = getopt_find_command(cmd->subcommands, word, &ambiguous);
+        if (sub != NULL && (sub->spec.options == NULL || state->depth >= GETOPT_COMMAND_MAX_DEPTH))
+        {
+            /* the name exists, so this is a broken command tree, not bad input */
+            d->error      = GETOPT_ERROR_INVALID_SPEC;
+            d->optopt     = 0;
+            d->optind     = start;
+            state->failed = 1;
+            errno         = EINVAL;
+            return (BADCH);
+        }
+        if (sub == NULL)
+        {
+            options = cmd->spec.options;
+            /* PRINT_ERROR looks past a leading '+' or '-' */
+            if (*options == '+' || *options == '-')
+                options++;
+            if (PRINT_ERROR)
+                getopt_warnx(ambiguous ? GETOPT_ERR_MSG_AMBIGCOMMAND : GETOPT_ERR_MSG_ILLCOMMAND, word);
+            d->error      = ambiguous ? GETOPT_ERROR_AMBIGUOUS : GETOPT_ERROR_UNKNOWN_COMMAND;
+            d->optopt     = 0;
+            d->optind     = start; /* leave the name for the caller to report */
+            state->failed = 1;
+            return (BADCH);
+        }
+        if (word == nargv[d->optind])
+            d->optind++; /* step over the command name */
+        state->path[state->depth++] = sub;
+    }
+}
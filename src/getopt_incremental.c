@@ -0,0 +1,217 @@
+/* SPDX-License-Identifier: 0BSD AND BSD-2-Clause */
+/* Modifications Copyright 2022 Seagate Technology and/or its Affiliates */
+
+/*
+ * getopt_incremental_*(): keep a tokenised argv up to date across edits.
+ */
+
+#include "getopt_internal.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Reset token i of an incremental parse.
+ */
+static void getopt_token_set(struct getopt_incremental* inc, int i, int kind, int owner)
+{
+    inc->tokens[i].kind       = kind;
+    inc->tokens[i].owner      = owner;
+    inc->tokens[i].value      = 0;
+    inc->tokens[i].long_index = -1;
+    inc->tokens[i].options    = 0;
+    inc->tokens[i].error      = GETOPT_ERROR_NONE;
+    inc->tokens[i].optopt     = 0;
+}
+
+/*
+ * Classify the words of inc->argv from the word boundary start on. Words
+ * from dirty_end on still hold the tokens of the previous parse; stop at
+ * the first of them that began a parse step then and does so again now,
+ * since everything after it parses as before.
+ */
+static void getopt_incremental_scan(struct getopt_incremental* inc, int start, int dirty_end)
+{
+    struct getopt_context ctx = GETOPT_CONTEXT_INIT;
+    getoptScan            scan;
+    int                   optchar, at, boundary, i, word = -1;
+    struct getopt_token*  t;
+
+    ctx.optind          = start;
+    ctx.posixly_correct = inc->posixly_correct;
+    getopt_scan_init(
+        &scan, &ctx, inc->spec.options, inc->spec.long_options, NULL, inc->spec.long_only ? FLAG_LONGONLY : 0, 1);
+    for (;;)
+    {
+        at       = ctx.optind;
+        boundary = (ctx.place == NULL || *ctx.place == '\0');
+        if (boundary)
+        {
+            if (at >= inc->argc)
+                break;
+            t = &inc->tokens[at];
+            if (at >= dirty_end && t->owner == at && t->kind != GETOPT_TOKEN_REST && t->kind != GETOPT_TOKEN_PROGRAM)
+                break; /* the rest of argv parses as before */
+        }
+        optchar              = getopt_scan_next(&scan, inc->argc, inc->argv, &ctx);
+        inc->posixly_correct = ctx.posixly_correct;
+        if (optchar == -1)
+        {
+            /* "--", or a non-option that ends option parsing */
+            i = ctx.optind;
+            if (boundary && i == at + 1)
+                getopt_token_set(inc, at, GETOPT_TOKEN_TERMINATOR, at);
+            else if (i == word)
+                i++; /* "-a-" stops inside a word, which keeps its options */
+            for (; i < inc->argc; i++)
+            {
+                if (i >= dirty_end && inc->tokens[i].kind == GETOPT_TOKEN_REST)
+                    break;
+                getopt_token_set(inc, i, GETOPT_TOKEN_REST, i);
+            }
+            break;
+        }
+        if (boundary && getopt_scan_operand(&scan, optchar, inc->argv, &ctx))
+        {
+            getopt_token_set(inc, at, GETOPT_TOKEN_OPERAND, at);
+            continue;
+        }
+        if (ctx.optpos != word)
+        {
+            word = ctx.optpos;
+            getopt_token_set(inc, word, GETOPT_TOKEN_OPTION, word);
+        }
+        t             = &inc->tokens[word];
+        t->options++;
+        t->value      = optchar;
+        t->long_index = scan.idx;
+        if (ctx.error != GETOPT_ERROR_NONE && t->error == GETOPT_ERROR_NONE)
+        {
+            t->error  = ctx.error;
+            t->optopt = ctx.optopt;
+        }
+        for (i = word + 1; i < ctx.optind; i++)
+            getopt_token_set(inc, i, GETOPT_TOKEN_ARGUMENT, word);
+    }
+}
+
+/*
+ * Make room for nargc tokens.
+ */
+static int getopt_incremental_reserve(struct getopt_incremental* inc, int nargc)
+{
+    struct getopt_token* tokens;
+    int                  capacity;
+
+    if (nargc <= inc->capacity)
+        return (0);
+    capacity = inc->capacity ? inc->capacity : 16;
+    while (capacity < nargc)
+        capacity *= 2;
+    tokens = realloc(inc->tokens, (size_t)capacity * sizeof(struct getopt_token));
+    if (tokens == NULL)
+    {
+        errno = ENOMEM;
+        return (-1);
+    }
+    inc->tokens   = tokens;
+    inc->capacity = capacity;
+    return (0);
+}
+
+/*
+ * getopt_incremental_init --
+ *	Classify every word of argc/argv.
+ */
+int getopt_incremental_init(struct getopt_incremental* inc,
+                            const struct getopt_spec*  spec,
+                            int                        nargc,
+                            char* const*               nargv)
+{
+    if (inc == NULL || spec == NULL || spec->options == NULL || nargc < 0 || (nargc > 0 && nargv == NULL))
+    {
+        errno = EINVAL;
+        return (-1);
+    }
+    memset(inc, 0, sizeof(struct getopt_incremental));
+    inc->spec            = *spec;
+    inc->posixly_correct = -1;
+    if (getopt_incremental_reserve(inc, nargc) != 0)
+        return (-1);
+    inc->argc = nargc;
+    inc->argv = nargv;
+    if (nargc > 0)
+    {
+        getopt_token_set(inc, 0, GETOPT_TOKEN_PROGRAM, 0);
+        getopt_incremental_scan(inc, 1, nargc);
+    }
+    return (0);
+}
+
+/*
+ * getopt_incremental_update --
+ *	Re-classify the words affected by an edit of argv.
+ */
+int getopt_incremental_update(struct getopt_incremental* inc,
+                              int                        nargc,
+                              char* const*               nargv,
+                              int                        first,
+                              int                        removed,
+                              int                        inserted)
+{
+    int delta, tail, start, i;
+
+    if (inc == NULL || first < 0 || removed < 0 || inserted < 0 || first > inc->argc ||
+        removed > inc->argc - first || nargc != inc->argc - removed + inserted || (nargc > 0 && nargv == NULL))
+    {
+        errno = EINVAL;
+        return (-1);
+    }
+    if (getopt_incremental_reserve(inc, nargc) != 0)
+        return (-1);
+    delta = inserted - removed;
+    tail  = inc->argc - first - removed;
+    if (tail > 0)
+        memmove(
+            inc->tokens + first + inserted, inc->tokens + first + removed, (size_t)tail * sizeof(struct getopt_token));
+    for (i = first + inserted; i < nargc; i++)
+        inc->tokens[i].owner += delta;
+    inc->argc = nargc;
+    inc->argv = nargv;
+    if (nargc == 0)
+        return (0);
+    getopt_token_set(inc, 0, GETOPT_TOKEN_PROGRAM, 0);
+
+    /*
+     * A word only depends on itself and on the words it takes as arguments,
+     * so restart at the word that owns the one before the edit.
+     */
+    start = first > 1 ? first - 1 : 1;
+    if (start < nargc && start < first && inc->tokens[start].kind == GETOPT_TOKEN_REST)
+    {
+        /* option parsing stopped before the edit */
+        for (i = first; i < first + inserted; i++)
+            getopt_token_set(inc, i, GETOPT_TOKEN_REST, i);
+        return (0);
+    }
+    if (start < first)
+        start = inc->tokens[start].owner;
+    getopt_incremental_scan(inc, start, first + inserted > 1 ? first + inserted : 1);
+    return (0);
+}
+
+/*
+ * getopt_incremental_free --
+ *	Release the tokens of an incremental parse.
+ */
+void getopt_incremental_free(struct getopt_incremental* inc)
+{
+    if (inc != NULL)
+    {
+        free(inc->tokens);
+        inc->tokens   = NULL;
+        inc->capacity = 0;
+        inc->argc     = 0;
+    }
+}
@@ -0,0 +1,202 @@
+/* SPDX-License-Identifier: 0BSD AND BSD-2-Clause */
+/* Modifications Copyright 2022 Seagate Technology and/or its Affiliates */
+
+/*
+ * Interface between the parser in getopt.c and the optional APIs built on
+ * it in the other getopt_*.c files. Each of those is its own translation
+ * unit so that a program calling only getopt() or getopt_long() links the
+ * parser alone. Not installed.
+ */
+
+#ifndef __GETOPT_INTERNAL_H__
+#define __GETOPT_INTERNAL_H__ // NOLINT
+
+/*
+ * Diagnostics profiles, chosen at build time:
+ *   default                      messages on stderr, or to the handler if set
+ *   GETOPT_DIAGNOSTIC_CALLBACK   messages only to the handler
+ *   DISABLE_GETOPT_DIAGNOSTICS   no messages at all
+ * Only the default profile uses stdio and looks up the program name.
+ */
+#if !defined(DISABLE_GETOPT_DIAGNOSTICS) && !defined(GETOPT_DIAGNOSTIC_CALLBACK)
+#define GETOPT_STDIO_DIAGNOSTICS
+#endif
+
+#include <getopt.h>
+#include <stddef.h>
+#if defined(HAVE_STD_INT) || (defined __STDC__ && defined __STDC_VERSION__ && __STDC_VERSION__ >= 199901L)
+#include <stdint.h>
+#elif !defined(_UINTPTR_T_DEFINED) && !defined(UINTPTR_MAX)
+/* uintptr_t does not exist so need to define what type it is as best we can */
+/* Checking known data model macros first and Windows predefined macros */
+#if defined(__LP64__) || defined(_LP64) || defined(__ILP64__) || defined(_ILP64)
+typedef unsigned long uintptr_t;
+#define UINTPTR_MAX FFFFFFFFFFFFFFFFUL;
+#elif defined(_WIN32)
+#if defined(_WIN64)
+typedef unsigned long long uintptr_t;
+#define UINTPTR_MAX FFFFFFFFFFFFFFFFULL;
+#else
+typedef unsigned long uintptr_t;
+#define UINTPTR_MAX FFFFFFFFUL;
+#endif
+#elif defined(__ILP32__) || defined(_ILP32) || defined(__LP32__) || defined(_LP32)
+typedef unsigned long uintptr_t;
+#define UINTPTR_MAX FFFFFFFFUL;
+#else /* done checking macros for various known data models. Fall back to CPU macros */
+#if defined(_WIN64) || defined(_M_IA64) || defined(_M_ALPHA) || defined(_M_X64) || defined(_M_AMD64) ||                \
+    defined(__alpha__) || defined(__amd64__) || defined(__x86_64__) || defined(__aarch64__) || defined(__ia64__) ||    \
+    defined(__IA64__) || defined(__powerpc64__) || defined(__PPC64__) || defined(__ppc64__) ||                         \
+    defined(_ARCH_PPC64) // 64bit
+/* 64bit and Windows already handled, so assuming unsigned long*/
+typedef unsigned long uintptr_t;
+#define UINTPTR_MAX FFFFFFFFFFFFFFFFUL
+#else
+/* 32bit, use unsigned long*/
+typedef unsigned long uintptr_t;
+#define UINTPTR_MAX FFFFFFFFUL;
+#endif
+#endif
+#endif // checking for stdint
+
+#define PRINT_ERROR ((d->opterr) && (*options != ':'))
+
+#define FLAG_PERMUTE  0x01 /* permute non-options to the end of argv */
+#define FLAG_ALLARGS  0x02 /* treat non-options as args to option "-1" */
+#define FLAG_LONGONLY 0x04 /* operate as getopt_long_only */
+#define FLAG_INPLACE  0x08 /* return non-options in place instead of permuting */
+#define FLAG_NOSTORE  0x10 /* do not store through struct option flag pointers */
+#define FLAG_SLASH    0x20 /* accept /option syntax (GETOPT_MODE_SLASH) */
+#define FLAG_SLASHARG 0x40 /* long option came as /name, ':' separates its argument too */
+#define FLAG_NOCASE   0x80 /* long option names ignore ASCII case (GETOPT_MODE_NOCASE) */
+
+/* return values */
+#define BADCH   (int)'?'
+#define BADARG  ((*options == ':') ? (int)':' : (int)'?')
+#define INORDER (int)1
+
+/*
+ * Long options can come from a classic NULL terminated struct option[] or from
+ * a packed table. The parser only reaches them through this descriptor and the
+ * longopt_* accessors in getopt.c so both formats share one code path.
+ */
+typedef struct sGetoptLongTable
+{
+    const struct option*          options;  /* classic table, or NULL */
+    const struct packed_options*  packed;   /* packed table, or NULL */
+    const struct getopt_registry* registry; /* namespaced tables, or NULL */
+} getoptLongTable;
+
+/*
+ * The option a long option name resolved to, possibly in one of several
+ * tables. index is -1 if nothing matched.
+ */
+typedef struct sLongoptMatch
+{
+    getoptLongTable table;     /* table holding the match */
+    int             index;     /* index into table */
+    int             base;      /* added to index for *idx */
+    int             exact;     /* name matched exactly */
+    int             ambiguous; /* a second, different partial match */
+} longoptMatch;
+
+/*
+ * State of a side effect free walk over argv, see getopt_scan_init().
+ */
+typedef struct sGetoptScan
+{
+    getoptLongTable        table;        /* long options, if any */
+    const getoptLongTable* long_options; /* &table, or NULL */
+    const char*            options;      /* short options */
+    int                    flags;        /* FLAG_* for getopt_internal_r */
+    int                    start;        /* optind before the last step */
+    int                    idx;          /* long option index of the last step, or -1 */
+} getoptScan;
+
+/*
+ * Due to Warning about non-const format string, using an enum since this code uses
+ * it's own internal implementation of warnings/errors to select a constant string
+ * This warning only happens in Clang, but rather than disabling an otherwise useful
+ * warning, this enum can map to the correct warning/error output for us.
+ */
+typedef enum eGetoptErrorMessageEnum
+{
+    GETOPT_ERR_MSG_RECARGCHAR,
+    GETOPT_ERR_MSG_RECARGSTRING,
+    GETOPT_ERR_MSG_AMBIG,
+    GETOPT_ERR_MSG_NOARG,
+    GETOPT_ERR_MSG_ILLOPTCHAR,
+    GETOPT_ERR_MSG_ILLOPTSTRING,
+    GETOPT_ERR_MSG_BADVALUE,
+    GETOPT_ERR_MSG_NOSPACE,
+    GETOPT_ERR_MSG_ILLCOMMAND,
+    GETOPT_ERR_MSG_AMBIGCOMMAND,
+    GETOPT_ERR_MSG_ARGCLIMIT,
+    GETOPT_ERR_MSG_TOKENLIMIT,
+    GETOPT_ERR_MSG_CLUSTERLIMIT,
+    GETOPT_ERR_MSG_CONFLICT
+} eGetoptErrorMessage;
+
+/*
+ * The functions below are shared between the library's source files only
+ * and are not part of its interface. Keep them out of the dynamic symbol
+ * table of a shared ELF build.
+ */
+#if defined(__GNUC__) && !defined(_WIN32) && !defined(__CYGWIN__)
+#define GETOPT_HIDDEN __attribute__((visibility("hidden")))
+#else
+#define GETOPT_HIDDEN
+#endif
+
+/* getopt.c: the parser */
+GETOPT_HIDDEN int getopt_internal_r(int                    nargc,
+                                    char* const*           nargv,
+                                    const char*            options,
+                                    const getoptLongTable* long_options,
+                                    int*                   idx,
+                                    int                    flags,
+                                    struct getopt_context* d);
+GETOPT_HIDDEN int getopt_internal(int                    nargc,
+                                  char* const*           nargv,
+                                  const char*            options,
+                                  const getoptLongTable* long_options,
+                                  int*                   idx,
+                                  int                    flags);
+GETOPT_HIDDEN struct getopt_context* getopt_global_load(char* const* nargv);
+GETOPT_HIDDEN void                   getopt_global_store(const struct getopt_context* d);
+GETOPT_HIDDEN void                   getopt_warnx(eGetoptErrorMessage errmsg, ...);
+GETOPT_HIDDEN int                    getopt_posixly_correct(void);
+GETOPT_HIDDEN size_t                 getopt_strlen(const char* str);
+GETOPT_HIDDEN int                    getopt_fold_char(int c);
+
+/* getopt.c: long option lookup */
+GETOPT_HIDDEN const getoptLongTable* getopt_longopt_table(getoptLongTable*              table,
+                                                          const struct option*          options,
+                                                          const struct packed_options*  packed,
+                                                          const struct getopt_registry* registry);
+GETOPT_HIDDEN void getopt_longopt_match(const getoptLongTable* long_options,
+                                        const char*            arg,
+                                        size_t                 len,
+                                        int                    short_too,
+                                        int                    flags,
+                                        longoptMatch*          m);
+GETOPT_HIDDEN int  getopt_namespace_compare(const struct getopt_namespace* space, const char* name, size_t len);
+GETOPT_HIDDEN int  getopt_namespace_lower_bound(const struct getopt_registry* registry,
+                                                const char*                   name,
+                                                size_t                        len);
+
+/* getopt.c: side effect free scans */
+GETOPT_HIDDEN void getopt_scan_init(getoptScan*                  scan,
+                                    struct getopt_context*       d,
+                                    const char*                  options,
+                                    const struct option*         long_options,
+                                    const struct packed_options* packed,
+                                    int                          flags,
+                                    int                          quiet);
+GETOPT_HIDDEN int  getopt_scan_next(getoptScan* scan, int nargc, char* const* nargv, struct getopt_context* d);
+GETOPT_HIDDEN int  getopt_scan_operand(const getoptScan*            scan,
+                                       int                          optchar,
+                                       char* const*                 nargv,
+                                       const struct getopt_context* d);
+
+#endif /* __GETOPT_INTERNAL_H__ */
@@ -0,0 +1,190 @@
+/* SPDX-License-Identifier: 0BSD AND BSD-2-Clause */
+/* Modifications Copyright 2022 Seagate Technology and/or its Affiliates */
+
+/*
+ * Packed long option tables and the getopt_long*_packed() parsers.
+ */
+
+#include "getopt_internal.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <string.h>
+
+/*
+ * getopt_pack_options_size --
+ *	Compute the storage getopt_pack_options() needs for long_options.
+ */
+int getopt_pack_options_size(const struct option* long_options,
+                             size_t*              entry_count,
+                             size_t*              pool_size,
+                             size_t*              flag_slot_count)
+{
+    size_t entries = 0, pool = 0, slots = 0;
+    int    i, j;
+
+    if (long_options == NULL)
+    {
+        errno = EINVAL;
+        return (-1);
+    }
+    for (i = 0; long_options[i].name; i++)
+    {
+        entries++;
+        pool += getopt_strlen(long_options[i].name);
+        if (long_options[i].flag == NULL)
+            continue;
+        /* count each distinct flag pointer once */
+        for (j = 0; j < i; j++)
+        {
+            if (long_options[j].flag == long_options[i].flag)
+                break;
+        }
+        if (j == i)
+            slots++;
+    }
+    if (entry_count)
+        *entry_count = entries;
+    if (pool_size)
+        *pool_size = pool;
+    if (flag_slot_count)
+        *flag_slot_count = slots;
+    return (0);
+}
+
+/*
+ * getopt_pack_options --
+ *	Convert a struct option[] into a packed table.
+ */
+int getopt_pack_options(const struct option*   long_options,
+                        struct packed_option*  entries,
+                        size_t                 max_entries,
+                        char*                  pool,
+                        size_t                 pool_size,
+                        int**                  flag_slots,
+                        size_t                 max_flag_slots,
+                        struct packed_options* table)
+{
+    size_t count = 0, used = 0, slots = 0, len, slot;
+    int    i;
+
+    if (long_options == NULL || table == NULL)
+    {
+        errno = EINVAL;
+        return (-1);
+    }
+    for (i = 0; long_options[i].name; i++)
+    {
+        len = getopt_strlen(long_options[i].name);
+        if (count >= max_entries || count >= (size_t)INT_MAX || len > PACKED_OPTION_MAX_NAME_LEN ||
+            len > pool_size - used || used + len > PACKED_OPTION_MAX_POOL_SIZE ||
+            (unsigned)long_options[i].has_arg > optional_argument)
+        {
+            errno = ERANGE;
+            return (-1);
+        }
+        slot = 0;
+        if (long_options[i].flag != NULL)
+        {
+            for (slot = 0; slot < slots; slot++)
+            {
+                if (flag_slots[slot] == long_options[i].flag)
+                    break;
+            }
+            if (slot == slots)
+            {
+                if (slots >= max_flag_slots || slots >= PACKED_OPTION_MAX_FLAG_SLOTS)
+                {
+                    errno = ERANGE;
+                    return (-1);
+                }
+                flag_slots[slots++] = long_options[i].flag;
+            }
+            slot++; /* slot 0 is reserved for "no flag" */
+        }
+        memcpy(pool + used, long_options[i].name, len);
+        entries[count].name_off = (unsigned short)used;
+        entries[count].name_len = (unsigned char)len;
+        entries[count].info     = PACKED_OPTION_INFO(long_options[i].has_arg, slot);
+        entries[count].val      = long_options[i].val;
+        used += len;
+        count++;
+    }
+    table->options    = entries;
+    table->count      = (int)count;
+    table->pool       = pool;
+    table->flag_slots = flag_slots;
+    table->folded     = NULL;
+    return (0);
+}
+
+/*
+ * getopt_pack_fold --
+ *	Keep a lower case copy of the names of a packed table.
+ */
+int getopt_pack_fold(struct packed_options* table, char* folded, size_t size)
+{
+    size_t used = 0, end;
+    int    i;
+
+    if (table == NULL || (table->count > 0 && folded == NULL))
+    {
+        errno = EINVAL;
+        return (-1);
+    }
+    for (i = 0; i < table->count; i++)
+    {
+        end = (size_t)table->options[i].name_off + table->options[i].name_len;
+        if (end > used)
+            used = end;
+    }
+    if (used > size)
+    {
+        errno = ERANGE;
+        return (-1);
+    }
+    for (end = 0; end < used; end++)
+        folded[end] = (char)getopt_fold_char((unsigned char)table->pool[end]);
+    table->folded = folded;
+    return (0);
+}
+
+/*
+ * getopt_long_packed --
+ *	Parse argc/argv argument vector using a packed long option table.
+ */
+int getopt_long_packed(int                          nargc,
+                       char* const*                 nargv,
+                       const char*                  options,
+                       const struct packed_options* long_options,
+                       int*                         idx)
+{
+    getoptLongTable table;
+
+    return (getopt_internal(nargc,
+                            nargv,
+                            options,
+                            getopt_longopt_table(&table, NULL, long_options, NULL),
+                            idx,
+                            FLAG_PERMUTE));
+}
+
+/*
+ * getopt_long_only_packed --
+ *	Parse argc/argv argument vector using a packed long option table.
+ */
+int getopt_long_only_packed(int                          nargc,
+                            char* const*                 nargv,
+                            const char*                  options,
+                            const struct packed_options* long_options,
+                            int*                         idx)
+{
+    getoptLongTable table;
+
+    return (getopt_internal(nargc,
+                            nargv,
+                            options,
+                            getopt_longopt_table(&table, NULL, long_options, NULL),
+                            idx,
+                            FLAG_PERMUTE | FLAG_LONGONLY));
+}
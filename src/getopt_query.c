@@ -0,0 +1,212 @@
+/* SPDX-License-Identifier: 0BSD AND BSD-2-Clause */
+/* Modifications Copyright 2022 Seagate Technology and/or its Affiliates */
+
+/*
+ * getopt_query_*(): lazy lookups of single options in an argument vector.
+ */
+
+#include "getopt_internal.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * getopt_query_init --
+ *	Prepare a lazy query over argc/argv. Nothing is parsed yet.
+ */
+void getopt_query_init(struct getopt_query* query, const struct getopt_spec* spec, int nargc, char* const* nargv)
+{
+    memset(query, 0, sizeof(struct getopt_query));
+    if (spec != NULL)
+        query->spec = *spec;
+    query->argc        = nargc;
+    query->argv        = nargv;
+    query->error_index = -1;
+}
+
+/*
+ * getopt_query_free --
+ *	Release the index built for a query.
+ */
+void getopt_query_free(struct getopt_query* query)
+{
+    if (query != NULL)
+    {
+        free(query->entries);
+        query->entries  = NULL;
+        query->count    = 0;
+        query->capacity = 0;
+        query->built    = 0;
+    }
+}
+
+/*
+ * Parse argv once and record every option occurrence.
+ */
+static int getopt_query_build(struct getopt_query* query)
+{
+    struct getopt_context ctx = GETOPT_CONTEXT_INIT;
+    getoptScan            scan;
+    int                   optchar;
+
+    if (query->built)
+        return (0);
+    if (query->spec.options == NULL)
+    {
+        errno = EINVAL;
+        return (-1);
+    }
+    /* start over if an earlier build ran out of memory part way */
+    query->count       = 0;
+    query->error       = GETOPT_ERROR_NONE;
+    query->error_index = -1;
+    ctx.limits         = query->spec.limits;
+    getopt_scan_init(&scan,
+                     &ctx,
+                     query->spec.options,
+                     query->spec.long_options,
+                     NULL,
+                     query->spec.long_only ? FLAG_LONGONLY : 0,
+                     1);
+    while (query->argv != NULL && query->argc > 0)
+    {
+        optchar = getopt_scan_next(&scan, query->argc, query->argv, &ctx);
+        if (optchar == -1)
+            break;
+        if (ctx.error != GETOPT_ERROR_NONE)
+        {
+            query->error       = ctx.error;
+            query->error_index = scan.start;
+            break;
+        }
+        if (getopt_scan_operand(&scan, optchar, query->argv, &ctx))
+            continue; /* operand */
+        if (query->count == query->capacity)
+        {
+            int                        capacity = query->capacity ? query->capacity * 2 : query->argc + 1;
+            struct getopt_query_entry* entries =
+                realloc(query->entries, (size_t)capacity * sizeof(struct getopt_query_entry));
+            if (entries == NULL)
+            {
+                errno = ENOMEM;
+                return (-1);
+            }
+            query->entries  = entries;
+            query->capacity = capacity;
+        }
+        query->entries[query->count].value      = optchar;
+        query->entries[query->count].long_index = scan.idx;
+        query->entries[query->count].index      = scan.start;
+        query->entries[query->count].arg        = ctx.optarg;
+        query->count++;
+    }
+    query->built = 1;
+    return (0);
+}
+
+/*
+ * Find the long option called name exactly. Returns its index or -1.
+ */
+static int getopt_query_find_long(const struct getopt_query* query, const char* name)
+{
+    int i;
+
+    if (query->spec.long_options == NULL || name == NULL)
+        return (-1);
+    for (i = 0; query->spec.long_options[i].name; i++)
+    {
+        if (strcmp(query->spec.long_options[i].name, name) == 0)
+            return (i);
+    }
+    return (-1);
+}
+
+/*
+ * Does entry e stand for long option li? Options without a flag are matched
+ * by the value they return, ones with a flag by flag and value.
+ */
+static int getopt_query_match_long(const struct getopt_query* query, const struct getopt_query_entry* e, int li)
+{
+    const struct option* lo = query->spec.long_options;
+
+    if (lo[li].flag == NULL)
+        return (e->value == lo[li].val);
+    return (e->long_index != -1 && lo[e->long_index].flag == lo[li].flag && lo[e->long_index].val == lo[li].val);
+}
+
+/*
+ * getopt_query_has --
+ *	Count occurrences of the long option name.
+ */
+int getopt_query_has(struct getopt_query* query, const char* name)
+{
+    int i, li, found = 0;
+
+    if (getopt_query_build(query) != 0)
+        return (-1);
+    if ((li = getopt_query_find_long(query, name)) == -1)
+        return (0);
+    for (i = 0; i < query->count; i++)
+    {
+        if (getopt_query_match_long(query, &query->entries[i], li))
+            found++;
+    }
+    return (found);
+}
+
+/*
+ * getopt_query_has_short --
+ *	Count occurrences of the option returning optchar.
+ */
+int getopt_query_has_short(struct getopt_query* query, int optchar)
+{
+    int i, found = 0;
+
+    if (getopt_query_build(query) != 0)
+        return (-1);
+    for (i = 0; i < query->count; i++)
+    {
+        if (query->entries[i].value == optchar)
+            found++;
+    }
+    return (found);
+}
+
+/*
+ * getopt_query_arg --
+ *	Argument of the last occurrence of the option returning optchar.
+ */
+const char* getopt_query_arg(struct getopt_query* query, int optchar)
+{
+    int i;
+
+    if (getopt_query_build(query) != 0)
+        return (NULL);
+    for (i = query->count - 1; i >= 0; i--)
+    {
+        if (query->entries[i].value == optchar)
+            return (query->entries[i].arg);
+    }
+    return (NULL);
+}
+
+/*
+ * getopt_query_arg_long --
+ *	Argument of the last occurrence of the long option name.
+ */
+const char* getopt_query_arg_long(struct getopt_query* query, const char* name)
+{
+    int i, li;
+
+    if (getopt_query_build(query) != 0)
+        return (NULL);
+    if ((li = getopt_query_find_long(query, name)) == -1)
+        return (NULL);
+    for (i = query->count - 1; i >= 0; i--)
+    {
+        if (getopt_query_match_long(query, &query->entries[i], li))
+            return (query->entries[i].arg);
+    }
+    return (NULL);
+}
@@ -0,0 +1,159 @@
+/* SPDX-License-Identifier: 0BSD AND BSD-2-Clause */
+/* Modifications Copyright 2022 Seagate Technology and/or its Affiliates */
+
+/*
+ * Namespaced long option registries and the getopt_long*_registry() parsers.
+ */
+
+#include "getopt_internal.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * getopt_registry_add --
+ *	Register a long option table under a namespace prefix.
+ */
+int getopt_registry_add(struct getopt_registry* registry, const char* prefix, const struct option* long_options)
+{
+    struct getopt_namespace* spaces;
+    size_t                   len;
+    int                      n, count, capacity;
+
+    if (registry == NULL || prefix == NULL || long_options == NULL ||
+        strchr(prefix, GETOPT_NAMESPACE_SEPARATOR) != NULL || strchr(prefix, '=') != NULL)
+    {
+        errno = EINVAL;
+        return (-1);
+    }
+    for (count = 0; long_options[count].name != NULL; count++)
+    {
+        if (count == GETOPT_REGISTRY_MAX_OPTIONS)
+        {
+            errno = EINVAL;
+            return (-1);
+        }
+    }
+    len = getopt_strlen(prefix);
+    n   = getopt_namespace_lower_bound(registry, prefix, len);
+    if (n < registry->count && getopt_namespace_compare(&registry->spaces[n], prefix, len) == 0)
+    {
+        errno = EEXIST;
+        return (-1);
+    }
+    if (registry->count >= GETOPT_REGISTRY_MAX_NAMESPACES)
+    {
+        errno = ENOSPC;
+        return (-1);
+    }
+    if (registry->count == registry->capacity)
+    {
+        capacity = registry->capacity ? registry->capacity * 2 : 8;
+        spaces   = realloc(registry->spaces, (size_t)capacity * sizeof(struct getopt_namespace));
+        if (spaces == NULL)
+        {
+            errno = ENOMEM;
+            return (-1);
+        }
+        registry->spaces   = spaces;
+        registry->capacity = capacity;
+    }
+    memmove(registry->spaces + n + 1,
+            registry->spaces + n,
+            (size_t)(registry->count - n) * sizeof(struct getopt_namespace));
+    registry->spaces[n].prefix     = prefix;
+    registry->spaces[n].prefix_len = len;
+    registry->spaces[n].options    = long_options;
+    registry->count++;
+    return (0);
+}
+
+/*
+ * getopt_registry_remove --
+ *	Unregister the table of a namespace.
+ */
+int getopt_registry_remove(struct getopt_registry* registry, const char* prefix)
+{
+    size_t len;
+    int    n;
+
+    if (registry == NULL || prefix == NULL)
+    {
+        errno = EINVAL;
+        return (-1);
+    }
+    len = getopt_strlen(prefix);
+    n   = getopt_namespace_lower_bound(registry, prefix, len);
+    if (n >= registry->count || getopt_namespace_compare(&registry->spaces[n], prefix, len) != 0)
+    {
+        errno = ENOENT;
+        return (-1);
+    }
+    registry->count--;
+    memmove(registry->spaces + n,
+            registry->spaces + n + 1,
+            (size_t)(registry->count - n) * sizeof(struct getopt_namespace));
+    return (0);
+}
+
+/*
+ * getopt_registry_free --
+ *	Release the namespace index of a registry.
+ */
+void getopt_registry_free(struct getopt_registry* registry)
+{
+    if (registry != NULL)
+    {
+        free(registry->spaces);
+        registry->spaces   = NULL;
+        registry->count    = 0;
+        registry->capacity = 0;
+    }
+}
+
+/*
+ * getopt_long_registry --
+ *	Parse argc/argv argument vector using a registry of long options.
+ */
+int getopt_long_registry(int                           nargc,
+                         char* const*                  nargv,
+                         const char*                   options,
+                         const struct getopt_registry* registry,
+                         int*                          idx)
+{
+    getoptLongTable table;
+
+    /* only a registered option sets it; don't leave the last one's behind */
+    if (idx != NULL)
+        *idx = -1;
+    return (getopt_internal(nargc,
+                            nargv,
+                            options,
+                            getopt_longopt_table(&table, NULL, NULL, registry),
+                            idx,
+                            FLAG_PERMUTE));
+}
+
+/*
+ * getopt_long_only_registry --
+ *	Parse argc/argv argument vector using a registry of long options.
+ */
+int getopt_long_only_registry(int                           nargc,
+                              char* const*                  nargv,
+                              const char*                   options,
+                              const struct getopt_registry* registry,
+                              int*                          idx)
+{
+    getoptLongTable table;
+
+    /* only a registered option sets it; don't leave the last one's behind */
+    if (idx != NULL)
+        *idx = -1;
+    return (getopt_internal(nargc,
+                            nargv,
+                            options,
+                            getopt_longopt_table(&table, NULL, NULL, registry),
+                            idx,
+                            FLAG_PERMUTE | FLAG_LONGONLY));
+}
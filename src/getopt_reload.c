@@ -0,0 +1,343 @@
+/* SPDX-License-Identifier: 0BSD AND BSD-2-Clause */
+/* Modifications Copyright 2022 Seagate Technology and/or its Affiliates */
+
+/*
+ * getopt_reload_*(): reparse argument sources and report what changed.
+ */
+
+#include "getopt_internal.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * getopt_reload_init --
+ *	Prepare a spec for repeated reloads.
+ */
+int getopt_reload_init(struct getopt_reload* reload, const struct getopt_spec* spec)
+{
+    size_t entries, pool, slots, offset;
+    char*  memory;
+
+    if (reload == NULL || spec == NULL || spec->options == NULL)
+    {
+        errno = EINVAL;
+        return (-1);
+    }
+    memset(reload, 0, sizeof(struct getopt_reload));
+    reload->spec          = *spec;
+    reload->limits        = spec->limits;
+    reload->error_source  = -1;
+    reload->verdict.index = -1;
+    if (spec->long_options == NULL || getopt_pack_options_size(spec->long_options, &entries, &pool, &slots) != 0)
+        return (0); /* nothing to pack, or too big to pack: use the table as is */
+
+    /* one block: entries, then flag slots, then the name pool */
+    offset = entries * sizeof(struct packed_option);
+    memory = malloc(offset + slots * sizeof(int*) + pool + 1);
+    if (memory == NULL)
+    {
+        errno = ENOMEM;
+        return (-1);
+    }
+    if (getopt_pack_options(spec->long_options,
+                            (struct packed_option*)(void*)memory,
+                            entries,
+                            memory + offset + slots * sizeof(int*),
+                            pool,
+                            (int**)(void*)(memory + offset),
+                            slots,
+                            &reload->table) != 0)
+    {
+        free(memory);
+        return (0);
+    }
+    reload->table_memory = memory;
+    return (0);
+}
+
+/*
+ * Order reload entries by option, flag setting options by their index.
+ * Occurrences of one option compare equal.
+ */
+static int reload_key_compare(const struct getopt_reload_entry* a, const struct getopt_reload_entry* b)
+{
+    int a_index = a->value == 0 ? a->long_index : -1;
+    int b_index = b->value == 0 ? b->long_index : -1;
+
+    if (a->value != b->value)
+        return (a->value < b->value ? -1 : 1);
+    if (a_index != b_index)
+        return (a_index < b_index ? -1 : 1);
+    return (0);
+}
+
+/*
+ * Order reload entries by option, then by occurrence.
+ */
+static int reload_entry_compare(const struct getopt_reload_entry* a, const struct getopt_reload_entry* b)
+{
+    int cmp;
+
+    if ((cmp = reload_key_compare(a, b)) != 0)
+        return (cmp);
+    return (a->occurrence < b->occurrence ? -1 : (a->occurrence > b->occurrence ? 1 : 0));
+}
+
+static int reload_entry_qsort(const void* a, const void* b)
+{
+    const struct getopt_reload_entry* ea = (const struct getopt_reload_entry*)a;
+    const struct getopt_reload_entry* eb = (const struct getopt_reload_entry*)b;
+    int                               cmp;
+
+    /* parse order first among equal options, so occurrences can be numbered */
+    if ((cmp = reload_key_compare(ea, eb)) != 0)
+        return (cmp);
+    return (ea->sequence < eb->sequence ? -1 : (ea->sequence > eb->sequence ? 1 : 0));
+}
+
+/*
+ * Append an occurrence, copying its argument into state->strings.
+ */
+static int reload_state_add(struct getopt_reload_state* state, int value, int long_index, const char* arg)
+{
+    struct getopt_reload_entry* entry;
+    size_t                      len;
+
+    if (state->count == state->capacity)
+    {
+        int capacity = state->capacity ? state->capacity * 2 : 16;
+        entry        = realloc(state->entries, (size_t)capacity * sizeof(struct getopt_reload_entry));
+        if (entry == NULL)
+            return (-1);
+        state->entries  = entry;
+        state->capacity = capacity;
+    }
+    entry             = &state->entries[state->count];
+    entry->value      = value;
+    entry->long_index = long_index;
+    entry->occurrence = 0;
+    entry->sequence   = state->count;
+    entry->arg        = (size_t)-1;
+    if (arg != NULL)
+    {
+        len = getopt_strlen(arg) + 1;
+        if (state->size - state->used < len)
+        {
+            size_t size    = state->size ? state->size : 256;
+            char*  strings;
+            while (size - state->used < len)
+                size *= 2;
+            if ((strings = realloc(state->strings, size)) == NULL)
+                return (-1);
+            state->strings = strings;
+            state->size    = size;
+        }
+        memcpy(state->strings + state->used, arg, len);
+        entry->arg = state->used;
+        state->used += len;
+    }
+    state->count++;
+    return (0);
+}
+
+/*
+ * Record one change between reload states.
+ */
+static int reload_add_change(struct getopt_reload*             reload,
+                             int                               kind,
+                             const struct getopt_reload_entry* entry,
+                             const char*                       old_arg,
+                             const char*                       new_arg)
+{
+    struct getopt_change* change;
+
+    if (reload->change_count == reload->change_capacity)
+    {
+        int capacity = reload->change_capacity ? reload->change_capacity * 2 : 16;
+        change       = realloc(reload->changes, (size_t)capacity * sizeof(struct getopt_change));
+        if (change == NULL)
+            return (-1);
+        reload->changes         = change;
+        reload->change_capacity = capacity;
+    }
+    change             = &reload->changes[reload->change_count++];
+    change->kind       = kind;
+    change->value      = entry->value;
+    change->long_index = entry->long_index;
+    change->occurrence = entry->occurrence;
+    change->old_arg    = old_arg;
+    change->new_arg    = new_arg;
+    return (0);
+}
+
+static const char* reload_arg(const struct getopt_reload_state* state, const struct getopt_reload_entry* entry)
+{
+    return (entry->arg == (size_t)-1 ? NULL : state->strings + entry->arg);
+}
+
+/*
+ * Compare two sorted reload states and record the differences.
+ */
+static int reload_diff(struct getopt_reload* reload, const struct getopt_reload_state* old_state,
+                       const struct getopt_reload_state* new_state)
+{
+    const struct getopt_reload_entry* o = old_state->entries;
+    const struct getopt_reload_entry* n = new_state->entries;
+    const char *                      old_arg, *new_arg;
+    int                               i = 0, j = 0, cmp, status = 0;
+
+    reload->change_count = 0;
+    while (status == 0 && (i < old_state->count || j < new_state->count))
+    {
+        if (i == old_state->count)
+            cmp = 1;
+        else if (j == new_state->count)
+            cmp = -1;
+        else
+            cmp = reload_entry_compare(&o[i], &n[j]);
+        if (cmp < 0)
+        {
+            status = reload_add_change(reload, GETOPT_CHANGE_REMOVED, &o[i], reload_arg(old_state, &o[i]), NULL);
+            i++;
+        }
+        else if (cmp > 0)
+        {
+            status = reload_add_change(reload, GETOPT_CHANGE_ADDED, &n[j], NULL, reload_arg(new_state, &n[j]));
+            j++;
+        }
+        else
+        {
+            old_arg = reload_arg(old_state, &o[i]);
+            new_arg = reload_arg(new_state, &n[j]);
+            if ((old_arg == NULL) != (new_arg == NULL) || (old_arg != NULL && strcmp(old_arg, new_arg) != 0))
+                status = reload_add_change(reload, GETOPT_CHANGE_CHANGED, &n[j], old_arg, new_arg);
+            i++;
+            j++;
+        }
+    }
+    return (status);
+}
+
+/*
+ * getopt_reload_apply --
+ *	Parse a new set of sources and report what changed.
+ */
+int getopt_reload_apply(struct getopt_reload* reload, const struct getopt_argv* sources, size_t count)
+{
+    struct getopt_reload_state next;
+    int                        optchar, i;
+    size_t                     source;
+
+    if (reload == NULL || (count > 0 && sources == NULL))
+    {
+        errno = EINVAL;
+        return (-1);
+    }
+
+    /* reuse the storage of the state before last */
+    next       = reload->previous;
+    next.count = 0;
+    next.used  = 0;
+    reload->error_source   = -1;
+    reload->verdict.error  = GETOPT_ERROR_NONE;
+    reload->verdict.index  = -1;
+    reload->verdict.optopt = 0;
+    if (reload->limits != NULL && reload->limits->max_expansion > 0)
+    {
+        /* count first, so an oversized set is refused before any parsing */
+        size_t words = 0;
+        for (source = 0; source < count; source++)
+        {
+            if (sources[source].argc > 1)
+                words += (size_t)sources[source].argc - 1;
+            if (words > reload->limits->max_expansion)
+            {
+                reload->verdict.error = GETOPT_ERROR_EXPANSION_TOO_LARGE;
+                reload->verdict.index =
+                    sources[source].argc - (int)(words - reload->limits->max_expansion);
+                reload->error_source = (int)source;
+                errno                = 0;
+                return (-1);
+            }
+        }
+    }
+    for (source = 0; source < count; source++)
+    {
+        struct getopt_context ctx  = GETOPT_CONTEXT_INIT;
+        char* const*          argv = sources[source].argv;
+        int                   argc = sources[source].argc;
+        getoptScan            scan;
+
+        ctx.limits = reload->limits;
+        /* the packed table is used when init could build it */
+        getopt_scan_init(&scan,
+                         &ctx,
+                         reload->spec.options,
+                         reload->table_memory != NULL ? NULL : reload->spec.long_options,
+                         reload->table_memory != NULL ? &reload->table : NULL,
+                         reload->spec.long_only ? FLAG_LONGONLY : 0,
+                         1);
+        while (argv != NULL && argc > 0)
+        {
+            optchar = getopt_scan_next(&scan, argc, argv, &ctx);
+            if (optchar == -1)
+                break;
+            if (ctx.error != GETOPT_ERROR_NONE)
+            {
+                reload->verdict.error  = ctx.error;
+                reload->verdict.index  = scan.start;
+                reload->verdict.optopt = ctx.optopt;
+                reload->error_source   = (int)source;
+                reload->previous       = next;
+                errno                  = 0;
+                return (-1);
+            }
+            if (reload_state_add(&next, optchar, scan.idx, ctx.optarg) != 0)
+            {
+                reload->previous = next;
+                errno            = ENOMEM;
+                return (-1);
+            }
+        }
+    }
+
+    /* sort by option, keeping parse order, and number the occurrences */
+    if (next.count > 1)
+        qsort(next.entries, (size_t)next.count, sizeof(struct getopt_reload_entry), reload_entry_qsort);
+    for (i = 1; i < next.count; i++)
+    {
+        next.entries[i].occurrence = 0;
+        if (reload_key_compare(&next.entries[i - 1], &next.entries[i]) == 0)
+            next.entries[i].occurrence = next.entries[i - 1].occurrence + 1;
+    }
+    if (reload_diff(reload, &reload->current, &next) != 0)
+    {
+        reload->previous = next;
+        errno            = ENOMEM;
+        return (-1);
+    }
+    reload->previous = reload->current;
+    reload->current  = next;
+    return (reload->change_count);
+}
+
+/*
+ * getopt_reload_free --
+ *	Release everything held by a reload.
+ */
+void getopt_reload_free(struct getopt_reload* reload)
+{
+    if (reload != NULL)
+    {
+        free(reload->table_memory);
+        free(reload->current.entries);
+        free(reload->current.strings);
+        free(reload->previous.entries);
+        free(reload->previous.strings);
+        free(reload->changes);
+        memset(reload, 0, sizeof(struct getopt_reload));
+        reload->error_source = -1;
+    }
+}
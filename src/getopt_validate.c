@@ -0,0 +1,232 @@
+/* SPDX-License-Identifier: 0BSD AND BSD-2-Clause */
+/* Modifications Copyright 2022 Seagate Technology and/or its Affiliates */
+
+/*
+ * getopt_validate() and the batch validators, optionally threaded
+ * (GETOPT_THREADS).
+ */
+
+#include "getopt_internal.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#if defined(GETOPT_THREADS)
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+#endif /* GETOPT_THREADS */
+
+/*
+ * Validate one vector with context d, which the caller has initialised.
+ */
+static int getopt_validate_internal(const struct getopt_spec* spec,
+                                    int                       nargc,
+                                    char* const*              nargv,
+                                    struct getopt_verdict*    verdict,
+                                    struct getopt_context*    d)
+{
+    getoptScan scan;
+    int        optchar;
+
+    verdict->error  = GETOPT_ERROR_NONE;
+    verdict->index  = -1;
+    verdict->optopt = 0;
+    if (nargc < 1 || nargv == NULL)
+        return (0);
+    getopt_scan_init(&scan, d, spec->options, spec->long_options, NULL, spec->long_only ? FLAG_LONGONLY : 0, 1);
+    do
+        optchar = getopt_scan_next(&scan, nargc, nargv, d);
+    while (optchar != -1 && d->error == GETOPT_ERROR_NONE);
+    if (d->error == GETOPT_ERROR_NONE)
+        return (0);
+    verdict->error  = d->error;
+    verdict->index  = scan.start;
+    verdict->optopt = d->optopt;
+    return (-1);
+}
+
+/*
+ * getopt_validate --
+ *	Check argc/argv against spec without side effects.
+ */
+int getopt_validate(const struct getopt_spec* spec, int nargc, char* const* nargv, struct getopt_verdict* verdict)
+{
+    struct getopt_context ctx = GETOPT_CONTEXT_INIT;
+
+    if (spec == NULL || spec->options == NULL || verdict == NULL)
+    {
+        errno = EINVAL;
+        return (-1);
+    }
+    ctx.limits = spec->limits;
+    return (getopt_validate_internal(spec, nargc, nargv, verdict, &ctx));
+}
+
+/*
+ * Validate vectors [first, last) with POSIXLY_CORRECT already looked up.
+ */
+static size_t getopt_validate_chunk(const struct getopt_spec* spec,
+                                    const struct getopt_argv* vectors,
+                                    struct getopt_verdict*    verdicts,
+                                    size_t                    first,
+                                    size_t                    last,
+                                    int                       posixly)
+{
+    size_t i, invalid = 0;
+
+    for (i = first; i < last; i++)
+    {
+        struct getopt_context ctx = GETOPT_CONTEXT_INIT;
+        ctx.posixly_correct       = posixly;
+        ctx.limits                = spec->limits;
+        if (getopt_validate_internal(spec, vectors[i].argc, vectors[i].argv, &verdicts[i], &ctx) != 0)
+            invalid++;
+    }
+    return (invalid);
+}
+
+/*
+ * getopt_validate_batch --
+ *	Check many argument vectors against one spec.
+ */
+size_t getopt_validate_batch(const struct getopt_spec* spec,
+                             const struct getopt_argv* vectors,
+                             struct getopt_verdict*    verdicts,
+                             size_t                    count)
+{
+    return (getopt_validate_range(spec, vectors, verdicts, 0, count));
+}
+
+/*
+ * getopt_validate_range --
+ *	Check vectors [first, last) of a batch against one spec.
+ */
+size_t getopt_validate_range(const struct getopt_spec* spec,
+                             const struct getopt_argv* vectors,
+                             struct getopt_verdict*    verdicts,
+                             size_t                    first,
+                             size_t                    last)
+{
+    if (spec == NULL || spec->options == NULL || vectors == NULL || verdicts == NULL || first > last)
+    {
+        errno = EINVAL;
+        return (0); /* nothing was checked */
+    }
+    /* look POSIXLY_CORRECT up once for the whole range */
+    return (getopt_validate_chunk(spec, vectors, verdicts, first, last, getopt_posixly_correct()));
+}
+
+#if defined(GETOPT_THREADS)
+#define GETOPT_MAX_THREADS 64
+
+typedef struct
+{
+    const struct getopt_spec* spec;
+    const struct getopt_argv* vectors;
+    struct getopt_verdict*    verdicts;
+    size_t                    first;
+    size_t                    last;
+    int                       posixly;
+    int                       started;
+    size_t                    invalid;
+#if defined(_WIN32)
+    HANDLE thread;
+#else
+    pthread_t thread;
+#endif
+} getoptValidateJob;
+
+#if defined(_WIN32)
+static DWORD WINAPI getopt_validate_worker(LPVOID arg)
+#else
+static void* getopt_validate_worker(void* arg)
+#endif
+{
+    getoptValidateJob* job = (getoptValidateJob*)arg;
+
+    job->invalid = getopt_validate_chunk(job->spec, job->vectors, job->verdicts, job->first, job->last, job->posixly);
+#if defined(_WIN32)
+    return (0);
+#else
+    return (NULL);
+#endif
+}
+#endif /* GETOPT_THREADS */
+
+/*
+ * getopt_validate_batch_parallel --
+ *	Check many argument vectors against one spec on up to threads workers.
+ */
+size_t getopt_validate_batch_parallel(const struct getopt_spec* spec,
+                                      const struct getopt_argv* vectors,
+                                      struct getopt_verdict*    verdicts,
+                                      size_t                    count,
+                                      unsigned                  threads)
+{
+#if defined(GETOPT_THREADS)
+    getoptValidateJob* jobs;
+    size_t             chunk, invalid = 0;
+    unsigned           i;
+    int                posixly;
+
+    if (spec == NULL || spec->options == NULL || vectors == NULL || verdicts == NULL)
+    {
+        errno = EINVAL;
+        return (0);
+    }
+    if (threads > GETOPT_MAX_THREADS)
+        threads = GETOPT_MAX_THREADS;
+    if (threads > count)
+        threads = (unsigned)count;
+    if (threads < 2 || (jobs = (getoptValidateJob*)calloc(threads, sizeof(*jobs))) == NULL)
+        return (getopt_validate_range(spec, vectors, verdicts, 0, count));
+    /* read the environment once, before any worker starts */
+    posixly = getopt_posixly_correct();
+    chunk   = (count + threads - 1) / threads;
+    for (i = 0; i < threads; i++)
+    {
+        jobs[i].spec     = spec;
+        jobs[i].vectors  = vectors;
+        jobs[i].verdicts = verdicts;
+        jobs[i].first    = i * chunk < count ? i * chunk : count;
+        jobs[i].last     = jobs[i].first + chunk < count ? jobs[i].first + chunk : count;
+        jobs[i].posixly  = posixly;
+    }
+    /* the calling thread takes the first chunk itself */
+    for (i = 1; i < threads; i++)
+    {
+#if defined(_WIN32)
+        jobs[i].thread  = CreateThread(NULL, 0, getopt_validate_worker, &jobs[i], 0, NULL);
+        jobs[i].started = (jobs[i].thread != NULL);
+#else
+        jobs[i].started = (pthread_create(&jobs[i].thread, NULL, getopt_validate_worker, &jobs[i]) == 0);
+#endif
+    }
+    getopt_validate_worker(&jobs[0]);
+    for (i = 0; i < threads; i++)
+    {
+        if (i > 0 && jobs[i].started)
+        {
+#if defined(_WIN32)
+            WaitForSingleObject(jobs[i].thread, INFINITE);
+            CloseHandle(jobs[i].thread);
+#else
+            pthread_join(jobs[i].thread, NULL);
+#endif
+        }
+        else if (i > 0)
+        {
+            /* could not start a worker, so check its chunk here */
+            getopt_validate_worker(&jobs[i]);
+        }
+        invalid += jobs[i].invalid;
+    }
+    free(jobs);
+    return (invalid);
+#else
+    (void)threads;
+    return (getopt_validate_range(spec, vectors, verdicts, 0, count));
+#endif
+}
@@ -0,0 +1,227 @@
+/* SPDX-License-Identifier: 0BSD */
+
+/*
+ * Check getopt_long_bind() and getopt_long_derive(): values stored through
+ * bindings, implied options overridden by later explicit ones, overrides,
+ * conflicts, rejected values, and bound lists growing from the caller's
+ * storage into the arena.
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#define COUNT_OF(a) (sizeof(a) / sizeof((a)[0]))
+#define MANY        40
+
+enum
+{
+    OPT_FAST = 256,
+    OPT_VERIFY,
+    OPT_NO_VERIFY
+};
+
+struct config
+{
+    int                     verbose;
+    int                     quiet;
+    int                     fast;
+    int                     verify;
+    int                     no_verify;
+    int                     threads;
+    size_t                  cache;
+    const char*             output;
+    struct getopt_bind_list includes;
+};
+
+static const struct option long_options[] = {{"fast", no_argument, NULL, OPT_FAST},
+                                             {"verify", no_argument, NULL, OPT_VERIFY},
+                                             {"no-verify", no_argument, NULL, OPT_NO_VERIFY},
+                                             {NULL, 0, NULL, 0}};
+
+static const struct getopt_binding bindings[] = {{'v', GETOPT_BIND_COUNTER, offsetof(struct config, verbose)},
+                                                 {'q', GETOPT_BIND_BOOL, offsetof(struct config, quiet)},
+                                                 {OPT_FAST, GETOPT_BIND_BOOL, offsetof(struct config, fast)},
+                                                 {OPT_VERIFY, GETOPT_BIND_BOOL, offsetof(struct config, verify)},
+                                                 {OPT_NO_VERIFY, GETOPT_BIND_BOOL, offsetof(struct config, no_verify)},
+                                                 {'t', GETOPT_BIND_INT, offsetof(struct config, threads)},
+                                                 {'c', GETOPT_BIND_SIZE, offsetof(struct config, cache)},
+                                                 {'o', GETOPT_BIND_STRING, offsetof(struct config, output)},
+                                                 {'I', GETOPT_BIND_LIST, offsetof(struct config, includes)},
+                                                 {0, GETOPT_BIND_END, 0}};
+
+static const struct getopt_derivation rules[] = {{'q', GETOPT_DERIVE_OVERRIDES, 'v', NULL},
+                                                 {OPT_FAST, GETOPT_DERIVE_IMPLIES, OPT_NO_VERIFY, NULL},
+                                                 {OPT_FAST, GETOPT_DERIVE_IMPLIES, 't', "8"},
+                                                 {OPT_FAST, GETOPT_DERIVE_CONFLICTS, OPT_VERIFY, NULL},
+                                                 {0, GETOPT_DERIVE_END, 0, NULL}};
+
+static const struct getopt_spec spec = {"vqt:c:o:I:", long_options, 0, NULL};
+
+static int failures;
+
+static void expect(const char* what, int ok)
+{
+    if (!ok)
+    {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+/*
+ * Parse argv to the end with the closure, or with plain bindings when
+ * closure is NULL. Returns the first error, with its optopt in *optopt.
+ */
+static int parse(struct getopt_closure* closure, const struct getopt_binder* binder, int argc, char** argv, int* optopt)
+{
+    struct getopt_context ctx   = GETOPT_CONTEXT_INIT;
+    int                   error = GETOPT_ERROR_NONE;
+
+    ctx.opterr = 0;
+    if (closure != NULL)
+        getopt_closure_reset(closure);
+    for (;;)
+    {
+        int c = closure != NULL ? getopt_long_derive(argc, argv, &spec, closure, NULL, &ctx)
+                                : getopt_long_bind(argc, argv, &spec, binder, NULL, &ctx);
+        if (c == -1)
+            break;
+        if (c == '?' && error == GETOPT_ERROR_NONE)
+        {
+            error   = ctx.error;
+            *optopt = ctx.optopt;
+        }
+    }
+    return (error);
+}
+
+int main(void)
+{
+    static char           arena_storage[512];
+    static const char*    first_items[2];
+    struct config         cfg;
+    struct getopt_arena   arena  = {arena_storage, sizeof(arena_storage), 0};
+    struct getopt_binder  binder = {bindings, &cfg, &arena};
+    struct getopt_closure closure;
+    char*                 many[MANY * 2 + 1];
+    int                   optopt = 0, i, error;
+
+    if (getopt_closure_init(&closure, &binder, rules) != 0)
+    {
+        printf("getopt_closure_init failed\n");
+        return (1);
+    }
+
+    {
+        /* an implied value is overridden by a later explicit one, and the other way round */
+        char* explicit_later[]  = {(char*)"prog", (char*)"--fast", (char*)"-t", (char*)"2"};
+        char* explicit_before[] = {(char*)"prog", (char*)"-t2", (char*)"--fast", (char*)"-c", (char*)"4k"};
+
+        memset(&cfg, 0, sizeof(cfg));
+        error = parse(&closure, NULL, (int)COUNT_OF(explicit_later), explicit_later, &optopt);
+        expect("explicit -t after --fast wins",
+               error == GETOPT_ERROR_NONE && cfg.fast == 1 && cfg.no_verify == 1 && cfg.threads == 2);
+        memset(&cfg, 0, sizeof(cfg));
+        error = parse(&closure, NULL, (int)COUNT_OF(explicit_before), explicit_before, &optopt);
+        expect("--fast after -t wins",
+               error == GETOPT_ERROR_NONE && cfg.fast == 1 && cfg.threads == 8 && cfg.cache == 4096);
+    }
+
+    {
+        /* -q resets the counter -v built up; -v after it counts again */
+        char* argv[] = {(char*)"prog", (char*)"-vv", (char*)"-q", (char*)"-v", (char*)"-ofile"};
+
+        memset(&cfg, 0, sizeof(cfg));
+        error = parse(&closure, NULL, (int)COUNT_OF(argv), argv, &optopt);
+        expect("-q overrides -v",
+               error == GETOPT_ERROR_NONE && cfg.quiet == 1 && cfg.verbose == 1 && strcmp(cfg.output, "file") == 0);
+    }
+
+    {
+        /* a conflict is symmetric and stores nothing for the option that hit it */
+        char* fast_first[]   = {(char*)"prog", (char*)"--fast", (char*)"--verify"};
+        char* verify_first[] = {(char*)"prog", (char*)"--verify", (char*)"--fast"};
+
+        memset(&cfg, 0, sizeof(cfg));
+        error = parse(&closure, NULL, (int)COUNT_OF(fast_first), fast_first, &optopt);
+        expect("--verify after --fast conflicts",
+               error == GETOPT_ERROR_CONFLICT && optopt == OPT_VERIFY && cfg.fast == 1 && cfg.verify == 0);
+        memset(&cfg, 0, sizeof(cfg));
+        error = parse(&closure, NULL, (int)COUNT_OF(verify_first), verify_first, &optopt);
+        expect("--fast after --verify conflicts",
+               error == GETOPT_ERROR_CONFLICT && optopt == OPT_FAST && cfg.verify == 1 && cfg.fast == 0 &&
+                   cfg.threads == 0);
+    }
+
+    {
+        /* values that do not fit their field are refused and leave it alone */
+        char* big_int[]  = {(char*)"prog", (char*)"-t", (char*)"99999999999", (char*)"-t", (char*)"3"};
+        char* big_size[] = {(char*)"prog", (char*)"-c", (char*)"99999999999999999999g"};
+        char* junk[]     = {(char*)"prog", (char*)"-t", (char*)"12x"};
+
+        memset(&cfg, 0, sizeof(cfg));
+        error = parse(NULL, &binder, (int)COUNT_OF(big_int), big_int, &optopt);
+        expect("int out of range", error == GETOPT_ERROR_INVALID_VALUE && optopt == 't' && cfg.threads == 3);
+        memset(&cfg, 0, sizeof(cfg));
+        error = parse(NULL, &binder, (int)COUNT_OF(big_size), big_size, &optopt);
+        expect("size out of range", error == GETOPT_ERROR_INVALID_VALUE && optopt == 'c' && cfg.cache == 0);
+        memset(&cfg, 0, sizeof(cfg));
+        error = parse(&closure, NULL, (int)COUNT_OF(junk), junk, &optopt);
+        expect("trailing junk", error == GETOPT_ERROR_INVALID_VALUE && optopt == 't' && cfg.threads == 0);
+    }
+
+    /* a list outgrows the caller's two slots and then its first arena block */
+    many[0] = (char*)"prog";
+    for (i = 0; i < MANY; i++)
+    {
+        static char names[MANY][8];
+        snprintf(names[i], sizeof(names[i]), "dir%d", i);
+        many[1 + 2 * i] = (char*)"-I";
+        many[2 + 2 * i] = names[i];
+    }
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.includes.items    = first_items;
+    cfg.includes.capacity = COUNT_OF(first_items);
+    error                 = parse(NULL, &binder, MANY * 2 + 1, many, &optopt);
+    expect("list grows in the arena",
+           error == GETOPT_ERROR_NONE && cfg.includes.count == MANY && cfg.includes.capacity >= MANY &&
+               (const char*)cfg.includes.items >= arena_storage &&
+               (const char*)cfg.includes.items < arena_storage + sizeof(arena_storage));
+    for (i = 0; i < MANY; i++)
+        expect("list items kept in order", cfg.includes.items[i] == many[2 + 2 * i]);
+    expect("first items copied", first_items[0] == many[2] && first_items[1] == many[4]);
+
+    /* an exhausted arena fails the item that does not fit */
+    memset(&cfg, 0, sizeof(cfg));
+    arena.size = 8 * sizeof(char*);
+    arena.used = 0;
+    error      = parse(NULL, &binder, MANY * 2 + 1, many, &optopt);
+    expect("arena exhausted", error == GETOPT_ERROR_NO_SPACE && optopt == 'I' && cfg.includes.count == 8);
+    getopt_closure_free(&closure);
+
+    {
+        /* rules that could never apply cleanly are refused at init */
+        static const struct getopt_derivation bad_arg[]  = {{OPT_FAST, GETOPT_DERIVE_IMPLIES, 't', "many"},
+                                                            {0, GETOPT_DERIVE_END, 0, NULL}};
+        static const struct getopt_derivation bad_list[] = {{OPT_FAST, GETOPT_DERIVE_IMPLIES, 'I', "x"},
+                                                            {0, GETOPT_DERIVE_END, 0, NULL}};
+        static const struct getopt_derivation self[]     = {{OPT_FAST, GETOPT_DERIVE_IMPLIES, OPT_VERIFY, NULL},
+                                                            {OPT_FAST, GETOPT_DERIVE_CONFLICTS, OPT_VERIFY, NULL},
+                                                            {0, GETOPT_DERIVE_END, 0, NULL}};
+
+        errno = 0;
+        expect("implied value that does not convert",
+               getopt_closure_init(&closure, &binder, bad_arg) == -1 && errno == EINVAL);
+        errno = 0;
+        expect("implied list", getopt_closure_init(&closure, &binder, bad_list) == -1 && errno == EINVAL);
+        errno = 0;
+        expect("implies what it conflicts with", getopt_closure_init(&closure, &binder, self) == -1 && errno == EINVAL);
+    }
+
+    if (failures == 0)
+        printf("all bindings and derivations as expected\n");
+    return (failures != 0);
+}
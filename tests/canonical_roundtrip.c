@@ -0,0 +1,226 @@
+/* SPDX-License-Identifier: 0BSD */
+
+/*
+ * Round-trip check for getopt_long_canonical() and
+ * getopt_long_only_canonical(): random option specs and argument vectors
+ * are canonicalised, the result is parsed again and both parses have to
+ * return the same options, long option indexes, arguments and operands.
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define VECTORS    100000
+#define MAX_WORDS  7
+#define MAX_EVENTS 32
+#define MAX_LONG   6
+
+typedef struct
+{
+    int  ret;
+    int  idx;
+    char arg[32];
+    int  has_arg;
+} event;
+
+typedef struct
+{
+    event events[MAX_EVENTS];
+    int   count;
+    int   failed;
+    char  operands[MAX_WORDS * 2][32];
+    int   operand_count;
+} parse_result;
+
+static unsigned long rng_state = 12345;
+static int           flag_target;
+
+static unsigned rng(unsigned n)
+{
+    rng_state = rng_state * 1103515245UL + 12345UL;
+    return ((unsigned)(rng_state >> 16) % n);
+}
+
+static void parse(int                  long_only,
+                  const char*          options,
+                  const struct option* long_options,
+                  int                  nargc,
+                  char* const*         nargv,
+                  parse_result*        result)
+{
+    struct getopt_context ctx = GETOPT_CONTEXT_INIT;
+    char*                 argv[MAX_WORDS * 2 + 2];
+    int                   i, ret, idx;
+
+    memcpy(argv, nargv, (size_t)nargc * sizeof(char*));
+    argv[nargc] = NULL;
+    ctx.opterr  = 0;
+    memset(result, 0, sizeof(*result));
+    for (;;)
+    {
+        event* e = &result->events[result->count];
+        idx      = -1;
+        ret      = long_only ? getopt_long_only_r(nargc, argv, options, long_options, &idx, &ctx)
+                             : getopt_long_r(nargc, argv, options, long_options, &idx, &ctx);
+        if (ret == -1)
+            break;
+        if (ret == '?' || ret == ':' || result->count == MAX_EVENTS)
+        {
+            result->failed = 1;
+            return;
+        }
+        e->ret     = ret;
+        e->idx     = idx;
+        e->has_arg = (ctx.optarg != NULL);
+        if (ctx.optarg != NULL)
+            snprintf(e->arg, sizeof(e->arg), "%s", ctx.optarg);
+        result->count++;
+    }
+    for (i = ctx.optind; i < nargc; i++)
+        snprintf(result->operands[result->operand_count++], sizeof(result->operands[0]), "%s", argv[i]);
+}
+
+static int same(const parse_result* a, const parse_result* b)
+{
+    int i;
+
+    if (a->count != b->count || a->operand_count != b->operand_count)
+        return (0);
+    for (i = 0; i < a->count; i++)
+    {
+        if (a->events[i].ret != b->events[i].ret || a->events[i].idx != b->events[i].idx ||
+            a->events[i].has_arg != b->events[i].has_arg || strcmp(a->events[i].arg, b->events[i].arg) != 0)
+            return (0);
+    }
+    for (i = 0; i < a->operand_count; i++)
+    {
+        if (strcmp(a->operands[i], b->operands[i]) != 0)
+            return (0);
+    }
+    return (1);
+}
+
+static void random_options(char* options)
+{
+    static const char  prefixes[][2] = {"", "+", "-", ":"};
+    static const char  letters[]     = "abov";
+    static const char* suffixes[]    = {"", ":", "::"};
+    size_t             i;
+
+    strcpy(options, prefixes[rng(4)]);
+    for (i = 0; i < sizeof(letters) - 1; i++)
+    {
+        if (rng(4) == 0)
+            continue;
+        strncat(options, &letters[i], 1);
+        strcat(options, suffixes[rng(3)]);
+    }
+    if (rng(4) == 0)
+        strcat(options, "W;");
+}
+
+static void random_long_options(struct option* long_options, char names[MAX_LONG][8])
+{
+    static const char* pool[] = {"a", "ab", "abc", "b", "bo", "o", "out", "v", "verbose", "W"};
+    int                count  = (int)rng(MAX_LONG);
+    int                i;
+
+    for (i = 0; i < count; i++)
+    {
+        strcpy(names[i], pool[rng(sizeof(pool) / sizeof(pool[0]))]);
+        long_options[i].name    = names[i];
+        long_options[i].has_arg = (int)rng(3);
+        long_options[i].flag    = rng(4) == 0 ? &flag_target : NULL;
+        long_options[i].val     = rng(2) ? "abov"[rng(4)] : 256 + i;
+    }
+    memset(&long_options[count], 0, sizeof(long_options[count]));
+}
+
+static void random_word(char* word)
+{
+    static const char  body[]     = "abovWx=1";
+    static const char* operands[] = {"x", "file", "ab", "o=1", "-", "--"};
+    int                len;
+
+    if (rng(4) == 0)
+    {
+        strcpy(word, operands[rng(6)]);
+        return;
+    }
+    strcpy(word, rng(3) == 0 ? "--" : "-");
+    for (len = 1 + (int)rng(4); len > 0; len--)
+        strncat(word, &body[rng(sizeof(body) - 1)], 1);
+}
+
+int main(void)
+{
+    static char   words[MAX_WORDS][16];
+    char          options[32], names[MAX_LONG][8], buf[512];
+    char*         argv[MAX_WORDS + 1];
+    char*         out[MAX_WORDS * 2 + 2];
+    struct option long_options[MAX_LONG + 1];
+    parse_result  original, again;
+    int           mode, v, i, argc, count, checked = 0, refused = 0;
+
+    for (mode = 0; mode < 2; mode++)
+    {
+        for (v = 0; v < VECTORS; v++)
+        {
+            struct getopt_context ctx = GETOPT_CONTEXT_INIT;
+            random_options(options);
+            random_long_options(long_options, names);
+            argc    = 1 + (int)rng(MAX_WORDS);
+            argv[0] = (char*)"prog";
+            for (i = 1; i < argc; i++)
+            {
+                random_word(words[i]);
+                argv[i] = words[i];
+            }
+            argv[argc] = NULL;
+            parse(mode, options, long_options, argc, argv, &original);
+            ctx.opterr = 0;
+            errno      = 0;
+            count      = mode ? getopt_long_only_canonical(
+                                argc, argv, options, long_options, out, MAX_WORDS * 2 + 2, buf, sizeof(buf), &ctx)
+                              : getopt_long_canonical(
+                                argc, argv, options, long_options, out, MAX_WORDS * 2 + 2, buf, sizeof(buf), &ctx);
+            if (count == -1)
+            {
+                /* only a parse error, or a long-only cluster, may be refused */
+                if (errno != EINVAL || (!original.failed && !mode))
+                {
+                    printf("canonical failed (errno %d) for options \"%s\":", errno, options);
+                    goto fail;
+                }
+                refused += !original.failed;
+                continue;
+            }
+            if (original.failed)
+            {
+                printf("canonical accepted a parse error for options \"%s\":", options);
+                goto fail;
+            }
+            parse(mode, options, long_options, count, out, &again);
+            if (again.failed || !same(&original, &again))
+            {
+                printf("round trip differs for options \"%s\":", options);
+                goto fail;
+            }
+            checked++;
+        }
+    }
+    printf("%d vectors round-tripped, %d long-only clusters refused\n", checked, refused);
+    return (0);
+
+fail:
+    for (i = 0; i < argc; i++)
+        printf(" %s", argv[i]);
+    printf(" ->");
+    for (i = 0; count > 0 && i < count; i++)
+        printf(" %s", out[i]);
+    printf("\n");
+    return (1);
+}
@@ -0,0 +1,92 @@
+/* SPDX-License-Identifier: 0BSD */
+
+/*
+ * Check how getopt_command_next() ends on a bad command name. An unknown,
+ * ambiguous or broken subcommand has to be reported once, with optind left
+ * at the name, and every later call has to return -1, so that the usual
+ * loop that carries on after '?' terminates.
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+
+#define COUNT_OF(a) (sizeof(a) / sizeof((a)[0]))
+#define MAX_CALLS   100
+
+static const struct getopt_command remote_commands[] = {{"add", {"f", NULL, 0, NULL}, NULL},
+                                                        {"remove", {"", NULL, 0, NULL}, NULL},
+                                                        {NULL, {NULL, NULL, 0, NULL}, NULL}};
+
+static const struct getopt_command commands[] = {{"remote", {"", NULL, 0, NULL}, remote_commands},
+                                                 {"rebase", {"i", NULL, 0, NULL}, NULL},
+                                                 {"broken", {NULL, NULL, 0, NULL}, NULL},
+                                                 {NULL, {NULL, NULL, 0, NULL}, NULL}};
+
+static int failures;
+
+/*
+ * Run the whole loop over argv with the root options given and check the
+ * one error it has to report.
+ */
+static void expect_error(const char* what, const char* options, int argc, char* const* argv, int error, int optind_at)
+{
+    struct getopt_command       root  = {"prog", {options, NULL, 0, NULL}, commands};
+    struct getopt_command_state state = GETOPT_COMMAND_STATE_INIT;
+    int                         calls = 0, errors = 0, seen = 0, c;
+
+    state.ctx.opterr = 0;
+    while ((c = getopt_command_next(argc, argv, &root, NULL, &state)) != -1 && calls++ < MAX_CALLS)
+    {
+        if (c == '?')
+        {
+            errors++;
+            seen = state.ctx.error;
+        }
+    }
+    if (calls >= MAX_CALLS || errors != 1 || seen != error || state.ctx.optind != optind_at ||
+        getopt_command_next(argc, argv, &root, NULL, &state) != -1)
+    {
+        printf("FAIL: %s: %d calls, %d errors, error %d, optind %d\n", what, calls, errors, seen, state.ctx.optind);
+        failures++;
+    }
+}
+
+int main(void)
+{
+    char* unknown[]   = {(char*)"prog", (char*)"-v", (char*)"bogus", (char*)"-f", (char*)"x"};
+    char* ambiguous[] = {(char*)"prog", (char*)"re", (char*)"-i"};
+    char* nested[]    = {(char*)"prog", (char*)"remote", (char*)"rename", (char*)"x"};
+    char* broken[]    = {(char*)"prog", (char*)"broken", (char*)"-v"};
+    char* good[]      = {(char*)"prog", (char*)"-v", (char*)"remote", (char*)"add", (char*)"-f", (char*)"x"};
+    int   c;
+
+    /* a plain root stops at the name, a '-' root returns it as INORDER first */
+    expect_error("unknown command", "v", (int)COUNT_OF(unknown), unknown, GETOPT_ERROR_UNKNOWN_COMMAND, 2);
+    expect_error("unknown command, in order", "-v", (int)COUNT_OF(unknown), unknown, GETOPT_ERROR_UNKNOWN_COMMAND, 2);
+    expect_error("ambiguous command", "v", (int)COUNT_OF(ambiguous), ambiguous, GETOPT_ERROR_AMBIGUOUS, 1);
+    expect_error("ambiguous command, in order", "-v", (int)COUNT_OF(ambiguous), ambiguous, GETOPT_ERROR_AMBIGUOUS, 1);
+    expect_error("unknown subcommand", "v", (int)COUNT_OF(nested), nested, GETOPT_ERROR_UNKNOWN_COMMAND, 2);
+    expect_error("command without a spec", "v", (int)COUNT_OF(broken), broken, GETOPT_ERROR_INVALID_SPEC, 1);
+
+    {
+        struct getopt_command       root  = {"prog", {"v", NULL, 0, NULL}, commands};
+        struct getopt_command_state state = GETOPT_COMMAND_STATE_INIT;
+        int                         v = 0, f = 0;
+
+        while ((c = getopt_command_next((int)COUNT_OF(good), good, &root, NULL, &state)) != -1)
+        {
+            v += c == 'v' && state.depth == 1;
+            f += c == 'f' && state.depth == 3;
+        }
+        if (v != 1 || f != 1 || state.depth != 3 || state.path[2] != &remote_commands[0] || state.ctx.optind != 5 ||
+            state.failed)
+        {
+            printf("FAIL: good command line\n");
+            failures++;
+        }
+    }
+
+    if (failures == 0)
+        printf("all command errors end the parse\n");
+    return (failures != 0);
+}
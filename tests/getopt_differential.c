@@ -0,0 +1,199 @@
+/* SPDX-License-Identifier: 0BSD */
+
+/*
+ * Differential test of the argv scanner against the previous one, kept in
+ * getopt_reference.c. Random option strings and argument vectors are
+ * parsed by both, step by step, through getopt, getopt_long,
+ * getopt_long_only, the packed tables and getopt_long_r, with and without
+ * POSIXLY_CORRECT. Return value, long option index, optind, optarg, optopt,
+ * flag stores and the permuted argv have to match after every step.
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define VECTORS   200000
+#define MAX_WORDS 8
+#define MAX_STEPS 20
+
+extern int   ref_optind, ref_opterr, ref_optopt, ref_optreset;
+extern char* ref_optarg;
+extern int   ref_getopt(int nargc, char* const* nargv, const char* options);
+extern int   ref_getopt_long(int nargc, char* const* nargv, const char* options, const struct option* long_options, int* idx);
+extern int   ref_getopt_long_only(int                  nargc,
+                                  char* const*         nargv,
+                                  const char*          options,
+                                  const struct option* long_options,
+                                  int*                 idx);
+
+enum
+{
+    KIND_GETOPT,
+    KIND_LONG,
+    KIND_LONG_ONLY,
+    KIND_PACKED,
+    KIND_PACKED_ONLY,
+    KIND_LONG_R,
+    KIND_COUNT
+};
+
+static int flag_a, flag_b;
+
+static const struct option long_options[] = {{"verbose", no_argument, NULL, 'v'},
+                                             {"verify", no_argument, NULL, 'V'},
+                                             {"output", required_argument, NULL, 'o'},
+                                             {"out", optional_argument, NULL, 'O'},
+                                             {"flag", no_argument, &flag_a, 7},
+                                             {"flagx", no_argument, &flag_b, 8},
+                                             {"flagy", no_argument, &flag_a, 7},
+                                             {"a", no_argument, NULL, 1000},
+                                             {"help", no_argument, NULL, 'h'},
+                                             {"Wx", required_argument, NULL, 'w'},
+                                             {NULL, 0, NULL, 0}};
+
+static const char* words[] = {
+    "-", "--", "-v", "-abc", "-o", "-ofile", "--verb", "--verbose", "--ver", "--out",
+    "--out=x", "--output", "--output=y", "--flag", "--fla", "--flagy", "foo", "bar", "-W",
+    "-Wverbose", "verbose", "-x", "-a", "--a", "--h=3", "-:", "-vo", "--unknown", "-h",
+    "--=", "-W;", "--help=", "-aWout", "-c", "-b", "-v-", "-a-b", "-o-", "---", "--v",
+    "-Wout=", "", "--output=", "-v:", "-/", "/a", "-a/"};
+
+static const char* option_strings[] = {
+    "abc", "ab:c::o:vhW;", "+abo:v", "-ab:o:", ":abo:v", "W;ab:", "-:ab", "+:o:W;", "", "-", "a-b", "a/:"};
+
+#define COUNT_OF(a) (sizeof(a) / sizeof((a)[0]))
+
+static unsigned long rng_state = 1;
+
+static unsigned rng(unsigned n)
+{
+    rng_state = rng_state * 1103515245UL + 12345UL;
+    return ((unsigned)(rng_state >> 16) % n);
+}
+
+static void set_posixly_correct(int on)
+{
+#if defined(_WIN32)
+    _putenv_s("POSIXLY_CORRECT", on ? "1" : "");
+#else
+    if (on)
+        setenv("POSIXLY_CORRECT", "1", 1);
+    else
+        unsetenv("POSIXLY_CORRECT");
+#endif
+}
+
+int main(void)
+{
+    static struct packed_option entries[16];
+    static char                 pool[128];
+    static int*                 slots[4];
+    struct packed_options       packed;
+    struct getopt_context       initial = GETOPT_CONTEXT_INIT;
+    struct getopt_context       ctx;
+    size_t                      entry_count, pool_size, slot_count;
+    char*                       ref_argv[MAX_WORDS + 1];
+    char*                       new_argv[MAX_WORDS + 1];
+    int                         env, v, i, n, kind, step, checked = 0;
+
+    if (getopt_pack_options_size(long_options, &entry_count, &pool_size, &slot_count) != 0 ||
+        getopt_pack_options(long_options, entries, 16, pool, pool_size, slots, slot_count, &packed) != 0)
+    {
+        printf("getopt_pack_options failed\n");
+        return (1);
+    }
+    for (env = 0; env < 2; env++)
+    {
+        set_posixly_correct(env);
+        for (v = 0; v < VECTORS; v++)
+        {
+            const char* options = option_strings[rng(COUNT_OF(option_strings))];
+            n                   = 1 + (int)rng(MAX_WORDS);
+            kind                = (int)rng(KIND_COUNT);
+            ref_argv[0] = new_argv[0] = (char*)"prog";
+            for (i = 1; i < n; i++)
+                ref_argv[i] = new_argv[i] = (char*)words[rng(COUNT_OF(words))];
+            ref_argv[n] = new_argv[n] = NULL;
+
+            ref_optind = optind = 0;
+            ref_opterr = opterr = 0;
+            ref_optopt = optopt = '?';
+            ctx        = initial;
+            ctx.opterr = 0;
+            for (step = 0; step < MAX_STEPS; step++)
+            {
+                int ref_ret, new_ret, ref_idx = -5, new_idx = -5, ref_a, ref_b;
+                int new_optind, new_optopt;
+                char* new_optarg;
+
+                flag_a = flag_b = 0;
+                if (kind == KIND_GETOPT)
+                    ref_ret = ref_getopt(n, ref_argv, options);
+                else if (kind == KIND_LONG_ONLY || kind == KIND_PACKED_ONLY)
+                    ref_ret = ref_getopt_long_only(n, ref_argv, options, long_options, &ref_idx);
+                else
+                    ref_ret = ref_getopt_long(n, ref_argv, options, long_options, &ref_idx);
+                ref_a  = flag_a;
+                ref_b  = flag_b;
+                flag_a = flag_b = 0;
+
+                switch (kind)
+                {
+                case KIND_GETOPT:
+                    new_ret = getopt(n, new_argv, options);
+                    break;
+                case KIND_LONG:
+                    new_ret = getopt_long(n, new_argv, options, long_options, &new_idx);
+                    break;
+                case KIND_LONG_ONLY:
+                    new_ret = getopt_long_only(n, new_argv, options, long_options, &new_idx);
+                    break;
+                case KIND_PACKED:
+                    new_ret = getopt_long_packed(n, new_argv, options, &packed, &new_idx);
+                    break;
+                case KIND_PACKED_ONLY:
+                    new_ret = getopt_long_only_packed(n, new_argv, options, &packed, &new_idx);
+                    break;
+                default:
+                    new_ret = getopt_long_r(n, new_argv, options, long_options, &new_idx, &ctx);
+                    break;
+                }
+                new_optind = kind == KIND_LONG_R ? ctx.optind : optind;
+                new_optopt = kind == KIND_LONG_R ? ctx.optopt : optopt;
+                new_optarg = kind == KIND_LONG_R ? ctx.optarg : optarg;
+
+                if (new_ret != ref_ret || new_idx != ref_idx || new_optind != ref_optind || new_optarg != ref_optarg ||
+                    new_optopt != ref_optopt || flag_a != ref_a || flag_b != ref_b ||
+                    memcmp(ref_argv, new_argv, sizeof(ref_argv)) != 0)
+                {
+                    printf("mismatch: kind %d, POSIXLY_CORRECT %s, options \"%s\", step %d: returned %d/%d, idx "
+                           "%d/%d, optind %d/%d, optopt %d/%d\n",
+                           kind,
+                           env ? "set" : "unset",
+                           options,
+                           step,
+                           new_ret,
+                           ref_ret,
+                           new_idx,
+                           ref_idx,
+                           new_optind,
+                           ref_optind,
+                           new_optopt,
+                           ref_optopt);
+                    for (i = 0; i < n; i++)
+                        printf(" [%s]", ref_argv[i]);
+                    printf("\n");
+                    return (1);
+                }
+                checked++;
+                if (new_ret == -1)
+                    break;
+            }
+        }
+    }
+    set_posixly_correct(0);
+    printf("%d parse steps identical\n", checked);
+    return (0);
+}
@@ -0,0 +1,129 @@
+/* SPDX-License-Identifier: 0BSD */
+
+/*
+ * Check that getopt_incremental_update() agrees with a full parse: random
+ * argument vectors are edited over and over (words removed, inserted or
+ * replaced anywhere) and after every edit the updated tokens have to equal
+ * those of a fresh getopt_incremental_init() over the edited argv.
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define VECTORS   20000
+#define EDITS     30
+#define MAX_WORDS 60
+
+static const struct option long_options[] = {{"verbose", no_argument, NULL, 'v'},
+                                             {"verify", no_argument, NULL, 'V'},
+                                             {"output", required_argument, NULL, 'o'},
+                                             {"out", optional_argument, NULL, 'O'},
+                                             {"a", no_argument, NULL, 1000},
+                                             {"Wx", required_argument, NULL, 'w'},
+                                             {NULL, 0, NULL, 0}};
+
+static const char* words[] = {
+    "-", "--", "-v", "-abc", "-o", "-ofile", "--verb", "--out", "--out=x", "--output",
+    "foo", "bar", "-W", "-Wverbose", "verbose", "-x", "-a", "-a-", "-:", "-vo",
+    "--unknown", "-b", "-c", "-W;", "---"};
+
+static const char* option_strings[] = {"abc", "ab:c::o:vW;", "+abo:v", "-ab:o:", ":abo:v", "W;ab:", "-:ab", "+:o:W;", ""};
+
+#define COUNT_OF(a) (sizeof(a) / sizeof((a)[0]))
+
+static unsigned long rng_state = 1;
+
+static unsigned rng(unsigned n)
+{
+    rng_state = rng_state * 1103515245UL + 12345UL;
+    return ((unsigned)(rng_state >> 16) % n);
+}
+
+static void dump(char* const* argv, int argc, const struct getopt_token* want, const struct getopt_token* got)
+{
+    int i;
+
+    for (i = 0; i < argc; i++)
+        printf("  %-10s init kind %d owner %d value %d options %d error %d | update kind %d owner %d value %d "
+               "options %d error %d\n",
+               argv[i],
+               want[i].kind,
+               want[i].owner,
+               want[i].value,
+               want[i].options,
+               want[i].error,
+               got[i].kind,
+               got[i].owner,
+               got[i].value,
+               got[i].options,
+               got[i].error);
+}
+
+int main(void)
+{
+    char*                     argv[MAX_WORDS + 1];
+    char*                     edited[MAX_WORDS + 1];
+    struct getopt_incremental inc, fresh;
+    struct getopt_spec        spec;
+    int                       v, e, i, argc, first, removed, inserted;
+    long                      edits = 0;
+
+    for (v = 0; v < VECTORS; v++)
+    {
+        spec.options      = option_strings[rng(COUNT_OF(option_strings))];
+        spec.long_options = rng(4) ? long_options : NULL;
+        spec.long_only    = (int)rng(2);
+        argc              = 1 + (int)rng(12);
+        argv[0]           = (char*)"prog";
+        for (i = 1; i < argc; i++)
+            argv[i] = (char*)words[rng(COUNT_OF(words))];
+        argv[argc] = NULL;
+        if (getopt_incremental_init(&inc, &spec, argc, argv) != 0)
+        {
+            printf("getopt_incremental_init failed\n");
+            return (1);
+        }
+        for (e = 0; e < EDITS; e++)
+        {
+            first   = (int)rng((unsigned)argc + 1);
+            removed = (int)rng((unsigned)(argc - first + 1));
+            if (rng(2) && removed > 2)
+                removed = 1;
+            inserted = (int)rng(3);
+            if (argc - removed + inserted > MAX_WORDS)
+                inserted = 0;
+            memcpy(edited, argv, (size_t)first * sizeof(char*));
+            for (i = 0; i < inserted; i++)
+                edited[first + i] = (char*)words[rng(COUNT_OF(words))];
+            memcpy(edited + first + inserted, argv + first + removed, (size_t)(argc - first - removed) * sizeof(char*));
+            argc         = argc - removed + inserted;
+            edited[argc] = NULL;
+            memcpy(argv, edited, (size_t)(argc + 1) * sizeof(char*));
+
+            if (getopt_incremental_update(&inc, argc, argv, first, removed, inserted) != 0 ||
+                getopt_incremental_init(&fresh, &spec, argc, argv) != 0)
+            {
+                printf("getopt_incremental_update or _init failed\n");
+                return (1);
+            }
+            if (argc > 0 && memcmp(fresh.tokens, inc.tokens, (size_t)argc * sizeof(struct getopt_token)) != 0)
+            {
+                printf("update differs from a full parse: options \"%s\", long_only %d, edit [%d, %d) -> %d words\n",
+                       spec.options,
+                       spec.long_only,
+                       first,
+                       first + removed,
+                       inserted);
+                dump(argv, argc, fresh.tokens, inc.tokens);
+                return (1);
+            }
+            getopt_incremental_free(&fresh);
+            edits++;
+        }
+        getopt_incremental_free(&inc);
+    }
+    printf("%ld edits matched a full parse\n", edits);
+    return (0);
+}
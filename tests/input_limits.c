@@ -0,0 +1,156 @@
+/* SPDX-License-Identifier: 0BSD */
+
+/*
+ * Check that struct getopt_limits bounds the work done on hostile input.
+ * Oversized words are left unterminated and end right before an
+ * inaccessible page. A parser that read one byte more than max_token + 1,
+ * or one argv entry past max_argc, would crash instead of failing the
+ * parse. Long clusters have to be cut off after max_cluster options.
+ */
+
+#include <getopt.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#define MAX_TOKEN   64
+#define MAX_CLUSTER 3
+#define MAX_ARGC    8
+#define MAX_CALLS   1000 /* give up on a parse that does not end */
+
+static const struct option long_options[] = {{"name", required_argument, NULL, 'n'}, {NULL, 0, NULL, 0}};
+
+static int failures;
+
+/*
+ * size bytes of fill, not terminated, directly followed by a page that
+ * cannot be read.
+ */
+static char* guarded(size_t size, char fill)
+{
+    size_t page, len;
+    char*  p;
+
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    DWORD       old;
+    GetSystemInfo(&info);
+    page = info.dwPageSize;
+    len  = (size + page - 1) / page * page;
+    p    = (char*)VirtualAlloc(NULL, len + page, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    if (p == NULL || !VirtualProtect(p + len, page, PAGE_NOACCESS, &old))
+        return (NULL);
+#else
+    page = (size_t)sysconf(_SC_PAGESIZE);
+    len  = (size + page - 1) / page * page;
+    p    = (char*)mmap(NULL, len + page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED || mprotect(p + len, page, PROT_NONE) != 0)
+        return (NULL);
+#endif
+    memset(p + len - size, fill, size);
+    return (p + len - size);
+}
+
+static void expect(const char* what, int ok)
+{
+    if (!ok)
+    {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+/*
+ * Parse argv to the end and return how many calls returned an option or
+ * an error; the first error is left in *error.
+ */
+static int parse(int nargc, char* const* nargv, const char* options, const struct getopt_limits* limits, int* error)
+{
+    struct getopt_context ctx = GETOPT_CONTEXT_INIT;
+    int                   calls = 0;
+
+    ctx.opterr = 0;
+    ctx.limits = limits;
+    *error     = GETOPT_ERROR_NONE;
+    while (getopt_long_r(nargc, nargv, options, long_options, NULL, &ctx) != -1)
+    {
+        if (*error == GETOPT_ERROR_NONE)
+            *error = ctx.error;
+        if (++calls == MAX_CALLS)
+            break;
+    }
+    return (calls);
+}
+
+int main(void)
+{
+    struct getopt_limits limits    = {MAX_ARGC, MAX_TOKEN, MAX_CLUSTER, 0};
+    struct getopt_limits unlimited = {0, (size_t)(-1), 0, 0};
+    char*                word      = guarded(MAX_TOKEN + 1, 'x');
+    char*                cluster   = guarded(1 << 20, 'v');
+    char**               argv      = (char**)(void*)guarded(MAX_ARGC * sizeof(char*), 0);
+    char*                plain[]   = {(char*)"prog", (char*)"-v", NULL};
+    int                  error, calls, i;
+
+    if (word == NULL || cluster == NULL || argv == NULL)
+    {
+        printf("cannot set up guard pages\n");
+        return (1);
+    }
+
+    {
+        /* an unterminated word read no further than max_token + 1 bytes */
+        char* long_word[] = {(char*)"prog", word, (char*)"-v", NULL};
+        char* short_arg[] = {(char*)"prog", (char*)"-n", word, (char*)"-v", NULL};
+        char* long_arg[]  = {(char*)"prog", (char*)"--name", word, (char*)"-v", NULL};
+        char* w_arg[]     = {(char*)"prog", (char*)"-W", word, NULL};
+
+        word[0] = '-';
+        word[1] = '-';
+        parse(3, long_word, "vn:", &limits, &error);
+        expect("long option word over max_token", error == GETOPT_ERROR_TOKEN_TOO_LONG);
+        word[1] = 'v';
+        parse(3, long_word, "vn:", &limits, &error);
+        expect("short option word over max_token", error == GETOPT_ERROR_TOKEN_TOO_LONG);
+        word[0] = 'x';
+        parse(4, short_arg, "vn:", &limits, &error);
+        expect("short option argument over max_token", error == GETOPT_ERROR_TOKEN_TOO_LONG);
+        parse(4, long_arg, "vn:", &limits, &error);
+        expect("long option argument over max_token", error == GETOPT_ERROR_TOKEN_TOO_LONG);
+        parse(3, w_arg, "vW;", &limits, &error);
+        expect("-W argument over max_token", error == GETOPT_ERROR_TOKEN_TOO_LONG);
+    }
+
+    {
+        /* a 1 MiB cluster costs max_cluster calls and one error */
+        struct getopt_limits cluster_only = {0, 0, MAX_CLUSTER, 0};
+        char*                long_cluster[] = {(char*)"prog", cluster, (char*)"-v", NULL};
+        cluster[0]                          = '-';
+        cluster[(1 << 20) - 1]              = '\0';
+        calls                               = parse(3, long_cluster, "v", &cluster_only, &error);
+        expect("cluster over max_cluster", error == GETOPT_ERROR_CLUSTER_TOO_LONG);
+        expect("cluster parse bounded", calls == MAX_CLUSTER + 2);
+    }
+
+    /* argv itself ends at the guard page, argc claims far more */
+    for (i = 0; i < MAX_ARGC; i++)
+        argv[i] = (char*)"-v";
+    calls = parse(INT_MAX, argv, "v", &limits, &error);
+    expect("argc over max_argc", error == GETOPT_ERROR_TOO_MANY_ARGS && calls == 1);
+    calls = parse(MAX_ARGC, argv, "v", &limits, &error);
+    expect("argc at max_argc", error == GETOPT_ERROR_NONE && calls == MAX_ARGC - 1);
+
+    /* max_token of SIZE_MAX is no limit, not a limit of -1 bytes */
+    calls = parse(2, plain, "v", &unlimited, &error);
+    expect("SIZE_MAX max_token", error == GETOPT_ERROR_NONE && calls == 1);
+
+    if (failures == 0)
+        printf("all limits held\n");
+    return (failures != 0);
+}
@@ -0,0 +1,27 @@
+# SPDX-License-Identifier: 0BSD
+#
+# Fail if any of OBJECTS refers to a stdio function, stream or the program
+# name, as the callback and none diagnostics profiles must not.
+#
+#   cmake -DNM=<nm> -DOBJECTS=<objects or archives> -P no_stdio.cmake
+
+if(NOT NM OR NOT OBJECTS)
+  message(FATAL_ERROR "usage: cmake -DNM=<nm> -DOBJECTS=<objects> -P no_stdio.cmake")
+endif()
+
+set(stdio_symbols "v?(f|s|sn)?printf|fput[cs]|putc|putchar|puts|fwrite|fflush|perror")
+set(stdio_symbols "${stdio_symbols}|stderr|stdout|_IO_[a-z_]+|__acrt_iob_func|progname")
+
+foreach(object ${OBJECTS})
+  execute_process(COMMAND ${NM} -u ${object} OUTPUT_VARIABLE undefined RESULT_VARIABLE result)
+  if(NOT result EQUAL 0)
+    message(FATAL_ERROR "${NM} -u ${object} failed")
+  endif()
+  # "U name", "U _name" (Mach-O) or "U __name_chk", optionally with @version
+  string(REGEX MATCHALL "[ _]_*(${stdio_symbols})(_chk)?(@[^\n]*)?\n" found "${undefined}\n")
+  if(found)
+    string(REPLACE "\n;" "," found "${found}")
+    string(STRIP "${found}" found)
+    message(SEND_ERROR "${object} uses ${found}")
+  endif()
+endforeach()
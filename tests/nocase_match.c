@@ -0,0 +1,141 @@
+/* SPDX-License-Identifier: 0BSD */
+
+/*
+ * Check GETOPT_MODE_NOCASE on every long option format: a struct option[]
+ * through getopt_long_r() and getopt_long(), and a packed table with and
+ * without the lower case copy of getopt_pack_fold(). Only 'A'-'Z' fold, so
+ * the neighbours of the letters and UTF-8 bytes must still differ, names
+ * longer than a machine word must compare in full, abbreviations and
+ * ambiguity work as without the mode, and short options keep their case.
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <string.h>
+
+#define COUNT_OF(a) (sizeof(a) / sizeof((a)[0]))
+
+static const struct option long_options[] = {{"verbose", no_argument, NULL, 'v'},
+                                             {"output-directory-name", required_argument, NULL, 'o'},
+                                             {"output-directory-namf", no_argument, NULL, 'f'},
+                                             {"at@sign", no_argument, NULL, 'a'},
+                                             {"bracket[", no_argument, NULL, 'b'},
+                                             {"\xc3\xa9t\xc3\xa9", no_argument, NULL, 'e'},
+                                             {"Mixed", no_argument, NULL, 'M'},
+                                             {NULL, 0, NULL, 0}};
+
+typedef struct
+{
+    const char* word;
+    int         nocase; /* first return with GETOPT_MODE_NOCASE */
+    int         exact;  /* and without it */
+} nocase_case;
+
+static const nocase_case cases[] = {
+    {"--verbose", 'v', 'v'},
+    {"--VERBOSE", 'v', '?'},
+    {"--VeR", 'v', '?'},
+    {"--OUTPUT-DIRECTORY-NAME=x", 'o', '?'},
+    {"--output-directory-namF", 'f', '?'},
+    {"--OUTPUT-DIRECTORY-NAMG", '?', '?'},
+    {"--Output-Directory-Nam", '?', '?'},
+    {"--AT@SIGN", 'a', '?'},
+    {"--AT`SIGN", '?', '?'},
+    {"--BRACKET[", 'b', '?'},
+    {"--bracket{", '?', '?'},
+    {"--\xc3\xa9T\xc3\xa9", 'e', '?'},
+    {"--\xc3\x89T\xc3\x89", '?', '?'},
+    {"--mixed", 'M', '?'},
+    {"--MIXED", 'M', '?'},
+    {"--Mixed", 'M', 'M'},
+    {"-v", 'v', 'v'},
+    {"-V", '?', '?'},
+};
+
+static int failures;
+
+static void expect(const char* what, int ok)
+{
+    if (!ok)
+    {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+/*
+ * First return for word with each parser: 0 getopt_long_r(), 1 getopt_long(),
+ * 2 getopt_long_packed() over table.
+ */
+static int first_option(int parser, const struct packed_options* table, const char* word, int mode)
+{
+    char* argv[] = {(char*)"prog", (char*)word, NULL};
+    int   c;
+
+    if (parser == 0)
+    {
+        struct getopt_context ctx = GETOPT_CONTEXT_INIT;
+
+        ctx.opterr = 0;
+        ctx.mode   = mode;
+        return (getopt_long_r(2, argv, "v", long_options, NULL, &ctx));
+    }
+    optind  = 1;
+    opterr  = 0;
+    optmode = mode;
+    if (parser == 1)
+        c = getopt_long(2, argv, "v", long_options, NULL);
+    else
+        c = getopt_long_packed(2, argv, "v", table, NULL);
+    optmode = 0;
+    return (c);
+}
+
+int main(void)
+{
+    static const char*    parsers[] = {"getopt_long_r", "getopt_long", "packed", "packed and folded"};
+    struct packed_option  entries[COUNT_OF(long_options)];
+    struct packed_options table;
+    char                  pool[128], folded[128];
+    int*                  slots[1];
+    size_t                pool_size, i;
+    int                   p, c;
+
+    if (getopt_pack_options_size(long_options, NULL, &pool_size, NULL) != 0 ||
+        getopt_pack_options(long_options, entries, COUNT_OF(entries), pool, sizeof(pool), slots, 0, &table) != 0)
+    {
+        printf("getopt_pack_options failed\n");
+        return (1);
+    }
+
+    for (p = 0; p < (int)COUNT_OF(parsers); p++)
+    {
+        if (p == 3)
+        {
+            errno = 0;
+            expect("fold buffer one byte short",
+                   getopt_pack_fold(&table, folded, pool_size - 1) == -1 && errno == ERANGE && table.folded == NULL);
+            expect("fold", getopt_pack_fold(&table, folded, pool_size) == 0 && table.folded == folded);
+        }
+        for (i = 0; i < COUNT_OF(cases); i++)
+        {
+            if ((c = first_option(p < 2 ? p : 2, &table, cases[i].word, GETOPT_MODE_NOCASE)) != cases[i].nocase)
+            {
+                printf("FAIL: %s: %s with NOCASE gave %d\n", parsers[p], cases[i].word, c);
+                failures++;
+            }
+            if ((c = first_option(p < 2 ? p : 2, &table, cases[i].word, 0)) != cases[i].exact)
+            {
+                printf("FAIL: %s: %s gave %d\n", parsers[p], cases[i].word, c);
+                failures++;
+            }
+        }
+    }
+    expect("pool keeps its case",
+           memcmp(pool + pool_size - 5, "Mixed", 5) == 0 && memcmp(folded + pool_size - 5, "mixed", 5) == 0);
+
+    if (failures == 0)
+        printf("all case-insensitive matches as expected\n");
+    return (failures != 0);
+}
@@ -0,0 +1,187 @@
+/* SPDX-License-Identifier: 0BSD */
+
+/*
+ * Check getopt_pack_options(): the storage getopt_pack_options_size()
+ * reports, each limit of the packed format (name length, string pool size,
+ * flag slots) accepted at its bound and refused with ERANGE one past it,
+ * buffers that are too small, and that a packed table parses as the
+ * struct option[] it came from.
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <string.h>
+
+#define COUNT_OF(a) (sizeof(a) / sizeof((a)[0]))
+#define LONG_NAMES  (PACKED_OPTION_MAX_POOL_SIZE / PACKED_OPTION_MAX_NAME_LEN + 1) /* 65535 is 257 * 255 */
+#define MANY_FLAGS  (PACKED_OPTION_MAX_FLAG_SLOTS + 1)
+
+static int failures;
+
+static void expect(const char* what, int ok)
+{
+    if (!ok)
+    {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static char                 names[LONG_NAMES][PACKED_OPTION_MAX_NAME_LEN + 2];
+static struct option        big[LONG_NAMES + 1];
+static struct packed_option entries[LONG_NAMES + 1];
+static char                 pool[PACKED_OPTION_MAX_POOL_SIZE + 16];
+static int                  flags[MANY_FLAGS];
+static int*                 slots[MANY_FLAGS];
+
+/*
+ * Pack options into the static buffers and return 0, or the errno of the
+ * failure.
+ */
+static int pack(const struct option* options, size_t max_entries, size_t pool_size, size_t max_slots)
+{
+    struct packed_options table;
+
+    errno = 0;
+    if (getopt_pack_options(options, entries, max_entries, pool, pool_size, slots, max_slots, &table) == 0)
+        return (0);
+    return (errno);
+}
+
+/*
+ * Parse argv once with getopt_long() and once with the packed table and
+ * check that every return, idx, optarg and flag store agree.
+ */
+static void expect_same_parse(const char* what, const struct option* options, int argc, char** argv)
+{
+    struct packed_options table;
+    int                   c[2][8], idx[2][8], n[2], i, pass;
+    int                   flag_after[2];
+    const char*           arg[2][8];
+
+    if (getopt_pack_options(options, entries, COUNT_OF(entries), pool, sizeof(pool), slots, MANY_FLAGS, &table) != 0)
+    {
+        printf("FAIL: %s: getopt_pack_options failed\n", what);
+        failures++;
+        return;
+    }
+    for (pass = 0; pass < 2; pass++)
+    {
+        optind   = 1;
+        opterr   = 0;
+        flags[0] = 0;
+        for (n[pass] = 0; n[pass] < 8; n[pass]++)
+        {
+            int k = n[pass];
+            idx[pass][k] = -1;
+            c[pass][k]   = pass == 0 ? getopt_long(argc, argv, "ab:", options, &idx[pass][k])
+                                     : getopt_long_packed(argc, argv, "ab:", &table, &idx[pass][k]);
+            arg[pass][k] = optarg;
+            if (c[pass][k] == -1)
+                break;
+        }
+        flag_after[pass] = flags[0];
+    }
+    if (n[0] != n[1] || flag_after[0] != flag_after[1])
+    {
+        printf("FAIL: %s: %d/%d options, flag %d/%d\n", what, n[0], n[1], flag_after[0], flag_after[1]);
+        failures++;
+        return;
+    }
+    for (i = 0; i < n[0]; i++)
+    {
+        if (c[0][i] != c[1][i] || idx[0][i] != idx[1][i] || arg[0][i] != arg[1][i])
+        {
+            printf("FAIL: %s: option %d: %d/%d idx %d/%d\n", what, i, c[0][i], c[1][i], idx[0][i], idx[1][i]);
+            failures++;
+        }
+    }
+}
+
+int main(void)
+{
+    size_t entry_count, pool_size, slot_count;
+    int    i;
+
+    {
+        /* flag pointers shared between options take one slot */
+        static const struct option options[] = {{"alpha", no_argument, &flags[0], 1},
+                                                {"alps", required_argument, NULL, 'p'},
+                                                {"beta", optional_argument, &flags[0], 2},
+                                                {"gamma", no_argument, &flags[1], 3},
+                                                {NULL, 0, NULL, 0}};
+        char* argv[] = {(char*)"prog", (char*)"--alph", (char*)"--alps=x", (char*)"-a", (char*)"--beta=y",
+                        (char*)"--al", (char*)"--alps", (char*)"z", (char*)"--delta"};
+
+        expect("size", getopt_pack_options_size(options, &entry_count, &pool_size, &slot_count) == 0 &&
+                           entry_count == 4 && pool_size == 18 && slot_count == 2);
+        expect("fits exactly", pack(options, 4, 18, 2) == 0);
+        expect("one entry short", pack(options, 3, 18, 2) == ERANGE);
+        expect("one pool byte short", pack(options, 4, 17, 2) == ERANGE);
+        expect("one flag slot short", pack(options, 4, 18, 1) == ERANGE);
+        expect_same_parse("small table", options, (int)COUNT_OF(argv), argv);
+    }
+
+    {
+        static const struct option bad_has_arg[] = {{"x", 3, NULL, 'x'}, {NULL, 0, NULL, 0}};
+
+        expect("has_arg out of range", pack(bad_has_arg, 1, 1, 0) == ERANGE);
+        expect("no table", pack(NULL, 1, 1, 0) == EINVAL);
+    }
+
+    /* the longest name, then one byte more */
+    memset(names[0], 'n', PACKED_OPTION_MAX_NAME_LEN);
+    big[0].name    = names[0];
+    big[0].has_arg = required_argument;
+    big[0].val     = 'n';
+    {
+        char  word[PACKED_OPTION_MAX_NAME_LEN + 4] = "--";
+        char* argv[]                               = {(char*)"prog", word, (char*)"v"};
+
+        memcpy(word + 2, names[0], PACKED_OPTION_MAX_NAME_LEN + 1);
+        expect("longest name", pack(big, 1, PACKED_OPTION_MAX_NAME_LEN, 0) == 0);
+        expect_same_parse("longest name", big, (int)COUNT_OF(argv), argv);
+    }
+    names[0][PACKED_OPTION_MAX_NAME_LEN] = 'n';
+    expect("name one byte too long", pack(big, 1, sizeof(pool), 0) == ERANGE);
+    names[0][PACKED_OPTION_MAX_NAME_LEN] = '\0';
+
+    /* longest names that fill the pool to its limit, then one byte more */
+    for (i = 0; i < LONG_NAMES - 1; i++)
+    {
+        memset(names[i], 'a' + i % 26, PACKED_OPTION_MAX_NAME_LEN);
+        big[i].name = names[i];
+    }
+    strcpy(names[LONG_NAMES - 1], "");
+    big[LONG_NAMES - 1].name = names[LONG_NAMES - 1];
+    expect("full pool size", getopt_pack_options_size(big, NULL, &pool_size, NULL) == 0 &&
+                                 pool_size == PACKED_OPTION_MAX_POOL_SIZE);
+    expect("full pool", pack(big, COUNT_OF(entries), sizeof(pool), 0) == 0);
+    strcpy(names[LONG_NAMES - 1], "x");
+    expect("pool one byte over", pack(big, COUNT_OF(entries), sizeof(pool), 0) == ERANGE);
+
+    /* every flag slot in use, then one more */
+    memset(big, 0, sizeof(big));
+    for (i = 0; i < MANY_FLAGS; i++)
+    {
+        snprintf(names[i], sizeof(names[i]), "flag%d", i);
+        big[i].name = names[i];
+        big[i].flag = &flags[i];
+        big[i].val  = 1;
+    }
+    big[MANY_FLAGS - 1].flag = &flags[0];
+    expect("all flag slots", pack(big, COUNT_OF(entries), sizeof(pool), COUNT_OF(slots)) == 0);
+    {
+        char* argv[] = {(char*)"prog", (char*)"--flag62", (char*)"--flag63"};
+
+        expect_same_parse("last flag slot", big, (int)COUNT_OF(argv), argv);
+        expect("last flag slot stored", flags[62] == 1);
+    }
+    big[MANY_FLAGS - 1].flag = &flags[MANY_FLAGS - 1];
+    expect("one flag slot too many", pack(big, COUNT_OF(entries), sizeof(pool), COUNT_OF(slots)) == ERANGE);
+
+    if (failures == 0)
+        printf("all packed table limits as expected\n");
+    return (failures != 0);
+}
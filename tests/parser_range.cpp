@@ -0,0 +1,123 @@
+/* SPDX-License-Identifier: 0BSD */
+
+/*
+ * Check the C++ range interface of getopt.hpp: a range-for over a parser
+ * sees every option with its argument and error, the operands are left in
+ * order at the end of argv, and a parser that has been moved from, or
+ * moved over, parses nothing more.
+ */
+
+#include <getopt.hpp>
+
+#include <cstdio>
+#include <string_view>
+#include <utility>
+
+#define COUNT_OF(a) (sizeof(a) / sizeof((a)[0]))
+
+static const struct option long_options[] = {{"output", required_argument, nullptr, 'o'},
+                                             {"verbose", no_argument, nullptr, 'v'},
+                                             {nullptr, 0, nullptr, 0}};
+
+static const getopt_spec spec = {"o:vq", long_options, 0, nullptr};
+
+static int failures;
+
+static void expect(const char* what, bool ok)
+{
+    if (!ok)
+    {
+        std::printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+int main()
+{
+    using wingetopt::error_kind;
+
+    {
+        /* every option in order, operands permuted to the end */
+        char* argv[] = {(char*)"prog",
+                        (char*)"in1",
+                        (char*)"-v",
+                        (char*)"--output=out",
+                        (char*)"in2",
+                        (char*)"-x",
+                        (char*)"-qo",
+                        (char*)"log",
+                        (char*)"--",
+                        (char*)"-v"};
+        auto  args   = wingetopt::parse(static_cast<int>(COUNT_OF(argv)), argv, spec);
+        int   ids[8] = {0};
+        int   n      = 0;
+
+        for (auto&& opt : args)
+        {
+            if (n < 8)
+                ids[n] = opt.id;
+            n++;
+            switch (opt.id)
+            {
+            case 'v':
+                expect("-v has no argument", !opt.has_arg && opt.arg.empty() && opt.long_index == -1);
+                break;
+            case 'o':
+                expect("-o argument",
+                       opt.has_arg && (opt.long_index == 0 ? opt.arg == "out" : opt.arg == "log"));
+                break;
+            case '?':
+                expect("-x unknown", opt.error == error_kind::unknown_option && args.context().optopt == 'x');
+                break;
+            default:
+                expect("-q has no error", opt.id == 'q' && opt.error == error_kind::none);
+                break;
+            }
+        }
+        expect("option order",
+               n == 5 && ids[0] == 'v' && ids[1] == 'o' && ids[2] == '?' && ids[3] == 'q' && ids[4] == 'o');
+
+        auto operands = args.operands();
+        expect("operands", operands.size() == 3 && operands[0] == "in1" && operands[1] == "in2" && operands[2] == "-v");
+        n = 0;
+        for (std::string_view operand : operands)
+            n += operand.size() != 0;
+        expect("operand range", n == 3);
+    }
+
+    {
+        /* a move mid-parse carries on in the target and empties the source */
+        char* argv[] = {(char*)"prog", (char*)"-v", (char*)"-o", (char*)"x", (char*)"file"};
+        wingetopt::parser first(static_cast<int>(COUNT_OF(argv)), argv, spec);
+        auto              it = first.begin();
+
+        expect("first option", it != first.end() && it->id == 'v');
+
+        wingetopt::parser second(std::move(first));
+
+        expect("old iterator at end", it == first.end());
+        expect("moved-from parser is empty", first.begin() == first.end() && first.operands().empty());
+
+        auto next = second.begin();
+        expect("moved-to parser carries on", next != second.end() && next->id == 'v');
+        ++next;
+        expect("second option", next != second.end() && next->id == 'o' && next->arg == "x");
+        ++next;
+        expect("moved-to parser ends", next == second.end() && second.operands().size() == 1 &&
+                                           second.operands()[0] == "file");
+
+        char* other_argv[] = {(char*)"prog", (char*)"-q"};
+        wingetopt::parser third(static_cast<int>(COUNT_OF(other_argv)), other_argv, spec);
+        int               n = 0;
+
+        third = std::move(second);
+        for (auto&& opt : third)
+            n += opt.id != 0;
+        expect("move assignment keeps the finished parse", n == 0 && third.operands().size() == 1);
+        expect("moved-from by assignment is empty", second.begin() == second.end() && second.operands().empty());
+    }
+
+    if (failures == 0)
+        std::printf("all parser ranges as expected\n");
+    return (failures != 0);
+}
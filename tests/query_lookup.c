@@ -0,0 +1,123 @@
+/* SPDX-License-Identifier: 0BSD */
+
+/*
+ * Check the getopt_query_*() lookups: occurrence counts and last arguments
+ * by short option and by long option name, long options that share a flag,
+ * names that are only abbreviations, an index that stops at an error or a
+ * limit, and that argv is left as it was.
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <string.h>
+
+#define COUNT_OF(a) (sizeof(a) / sizeof((a)[0]))
+
+static int level;
+
+static const struct option long_options[] = {{"output", required_argument, NULL, 'o'},
+                                             {"verbose", no_argument, NULL, 'v'},
+                                             {"quiet", no_argument, &level, 1},
+                                             {"loud", no_argument, &level, 2},
+                                             {"color", optional_argument, NULL, 'c'},
+                                             {NULL, 0, NULL, 0}};
+
+static const struct getopt_limits limits = {0, 8, 0, 0};
+
+static int failures;
+
+static void expect(const char* what, int ok)
+{
+    if (!ok)
+    {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static int same_arg(const char* a, const char* b)
+{
+    return (a == NULL ? b == NULL : b != NULL && strcmp(a, b) == 0);
+}
+
+int main(void)
+{
+    struct getopt_spec  spec = {"o:vx", long_options, 0, NULL};
+    struct getopt_query query;
+
+    {
+        char* argv[] = {(char*)"prog", (char*)"-v", (char*)"in", (char*)"--output=a", (char*)"-vv", (char*)"--out",
+                        (char*)"b", (char*)"--quiet", (char*)"--color=red", (char*)"--color", (char*)"--",
+                        (char*)"-o", (char*)"z"};
+        char* saved[COUNT_OF(argv)];
+
+        memcpy(saved, argv, sizeof(argv));
+        getopt_query_init(&query, &spec, (int)COUNT_OF(argv), argv);
+        expect("nothing parsed before the first query", !query.built && query.entries == NULL);
+        expect("-v count", getopt_query_has_short(&query, 'v') == 3);
+        expect("built on the first query", query.built && query.count == 8);
+        expect("--verbose counts -v", getopt_query_has(&query, "verbose") == 3);
+        expect("-o count", getopt_query_has_short(&query, 'o') == 2 && getopt_query_has(&query, "output") == 2);
+        expect("last -o argument", same_arg(getopt_query_arg(&query, 'o'), "b"));
+        expect("last --output argument", same_arg(getopt_query_arg_long(&query, "output"), "b"));
+        expect("flag option by name", getopt_query_has(&query, "quiet") == 1);
+        expect("same flag, other value", getopt_query_has(&query, "loud") == 0);
+        expect("flag option returns 0", getopt_query_has_short(&query, 0) == 1);
+        expect("optional argument count", getopt_query_has(&query, "color") == 2);
+        expect("last optional argument absent", getopt_query_arg_long(&query, "color") == NULL);
+        expect("option without an argument", getopt_query_arg(&query, 'v') == NULL);
+        expect("option not given", getopt_query_has_short(&query, 'x') == 0 && getopt_query_arg(&query, 'x') == NULL);
+        expect("abbreviation is not a name", getopt_query_has(&query, "out") == 0 &&
+                                                 getopt_query_arg_long(&query, "out") == NULL);
+        expect("unknown name", getopt_query_has(&query, "bogus") == 0 && getopt_query_has(&query, NULL) == 0);
+        expect("after --", query.error == GETOPT_ERROR_NONE && query.entries[query.count - 1].index == 9);
+        expect("argv untouched", memcmp(saved, argv, sizeof(argv)) == 0 && level == 0);
+
+        getopt_query_free(&query);
+        expect("rebuilt after free", getopt_query_has(&query, "output") == 2 && query.built);
+        getopt_query_free(&query);
+    }
+
+    {
+        /* the index stops at the first error */
+        char* argv[] = {(char*)"prog", (char*)"-v", (char*)"--output=a", (char*)"-z", (char*)"-o", (char*)"b"};
+
+        getopt_query_init(&query, &spec, (int)COUNT_OF(argv), argv);
+        expect("occurrences before the error", getopt_query_has_short(&query, 'o') == 1);
+        expect("argument before the error", same_arg(getopt_query_arg(&query, 'o'), "a"));
+        expect("error recorded", query.error == GETOPT_ERROR_UNKNOWN_OPTION && query.error_index == 3);
+        getopt_query_free(&query);
+    }
+
+    {
+        /* and at a word over the spec's limits */
+        char* argv[] = {(char*)"prog", (char*)"-o", (char*)"short", (char*)"-o", (char*)"much-too-long"};
+
+        spec.limits = &limits;
+        getopt_query_init(&query, &spec, (int)COUNT_OF(argv), argv);
+        expect("occurrences before the limit", getopt_query_has_short(&query, 'o') == 1);
+        expect("limit recorded", query.error == GETOPT_ERROR_TOKEN_TOO_LONG && query.error_index == 3);
+        getopt_query_free(&query);
+        spec.limits = NULL;
+    }
+
+    {
+        char* argv[] = {(char*)"prog", (char*)"-output", (char*)"x", (char*)"-v"};
+
+        spec.long_only = 1;
+        getopt_query_init(&query, &spec, (int)COUNT_OF(argv), argv);
+        expect("long only", getopt_query_has(&query, "output") == 1 && getopt_query_has_short(&query, 'v') == 1 &&
+                                same_arg(getopt_query_arg(&query, 'o'), "x"));
+        getopt_query_free(&query);
+    }
+
+    getopt_query_init(&query, NULL, 0, NULL);
+    errno = 0;
+    expect("no spec", getopt_query_has_short(&query, 'v') == -1 && errno == EINVAL);
+    getopt_query_free(&query);
+
+    if (failures == 0)
+        printf("all queries as expected\n");
+    return (failures != 0);
+}
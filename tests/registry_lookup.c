@@ -0,0 +1,155 @@
+/* SPDX-License-Identifier: 0BSD */
+
+/*
+ * Check getopt_registry_add()/getopt_registry_remove() and the lookup of
+ * getopt_long_registry(): "ns.name" only in namespace ns, abbreviations
+ * across namespaces, GETOPT_MODE_NOCASE, namespace indexes after a removal,
+ * and *idx on calls that do not return a registered option. Each command
+ * line is reduced to a trace of "c@namespace.option=arg" per option, with
+ * "?optopt" for an error and "@-" for an idx of -1.
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <string.h>
+
+#define COUNT_OF(a) (sizeof(a) / sizeof((a)[0]))
+#define MAX_WORDS   8
+
+static const struct option plain[] = {{"verbose", no_argument, NULL, 'v'}, {NULL, 0, NULL, 0}};
+
+static const struct option cache[] = {{"dir", required_argument, NULL, 'd'},
+                                      {"size", required_argument, NULL, 's'},
+                                      {NULL, 0, NULL, 0}};
+
+static const struct option cat[] = {{"dir", required_argument, NULL, 'D'}, {NULL, 0, NULL, 0}};
+
+static const struct option net[] = {{"port", required_argument, NULL, 'p'}, {NULL, 0, NULL, 0}};
+
+typedef struct
+{
+    const char* words[MAX_WORDS];
+    int         mode;
+    const char* trace;
+} registry_case;
+
+/* registered: "" 0, "cache" 1, "cat" 2, "net" 3 */
+static const registry_case cases[] = {
+    {{"prog", "--cache.dir=a", "--cat.dir", "b", "--net.port=1", NULL}, 0, "d@1.0=a D@2.0=b p@3.0=1"},
+    {{"prog", "--cache.d=a", "--cache.s", "2", "--n=3", "--verb", NULL}, 0, "d@1.0=a s@1.1=2 p@3.0=3 v@0.0"},
+    {{"prog", "--ca.dir=x", "--cache.bogus", "--ca", "--cache", "-v", NULL}, 0, "?0@- ?0@- ?0@- ?0@- v@-"},
+    {{"prog", "--cache.dir", NULL}, 0, "?d@-"},
+    {{"prog", "--verbose=1", "--dir=x", "--.dir=x", NULL}, 0, "?v@- ?0@- ?0@-"},
+    {{"prog", "--CACHE.DIR=a", "--Cat.Dir=b", "--NET", "1", NULL}, GETOPT_MODE_NOCASE, "d@1.0=a D@2.0=b p@3.0=1"},
+    {{"prog", "--CACHE.DIR=a", NULL}, 0, "?0@-"},
+    {{"prog", "--CA.dir=x", "--Ca", NULL}, GETOPT_MODE_NOCASE, "?0@- ?0@-"},
+};
+
+static int failures;
+
+static void expect(const char* what, int ok)
+{
+    if (!ok)
+    {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+/*
+ * Parse one case against registry and write its trace. idx starts out
+ * holding a valid index, so a call that leaves it alone shows up.
+ */
+static void run(const struct getopt_registry* registry, const registry_case* rc, char* trace, size_t size)
+{
+    char*  argv[MAX_WORDS + 1];
+    size_t used = 0;
+    int    argc, c, idx = 0;
+
+    for (argc = 0; rc->words[argc] != NULL; argc++)
+        argv[argc] = (char*)rc->words[argc];
+    argv[argc] = NULL;
+    optind     = 1;
+    opterr     = 0;
+    optmode    = rc->mode;
+    trace[0]   = '\0';
+    while ((c = getopt_long_registry(argc, argv, "v", registry, &idx)) != -1)
+    {
+        if (used > 0)
+            used += (size_t)snprintf(trace + used, size - used, " ");
+        if (c == '?')
+            used += (size_t)snprintf(trace + used, size - used, "?%c", optopt != 0 ? optopt : '0');
+        else
+            used += (size_t)snprintf(trace + used, size - used, "%c", c);
+        if (idx == -1)
+            used += (size_t)snprintf(trace + used, size - used, "@-");
+        else
+            used += (size_t)snprintf(
+                trace + used, size - used, "@%d.%d", GETOPT_REGISTRY_NAMESPACE(idx), GETOPT_REGISTRY_OPTION(idx));
+        if (c != '?' && optarg != NULL)
+            used += (size_t)snprintf(trace + used, size - used, "=%s", optarg);
+        idx = 0;
+    }
+    optmode = 0;
+}
+
+int main(void)
+{
+    struct getopt_registry registry = GETOPT_REGISTRY_INIT;
+    char                   trace[256];
+    size_t                 i;
+
+    /* added out of order, kept sorted by prefix */
+    expect("add net", getopt_registry_add(&registry, "net", net) == 0);
+    expect("add cat", getopt_registry_add(&registry, "cat", cat) == 0);
+    expect("add plain", getopt_registry_add(&registry, "", plain) == 0);
+    expect("add cache", getopt_registry_add(&registry, "cache", cache) == 0);
+    errno = 0;
+    expect("prefix taken", getopt_registry_add(&registry, "cat", net) == -1 && errno == EEXIST);
+    errno = 0;
+    expect("prefix with the separator", getopt_registry_add(&registry, "a.b", net) == -1 && errno == EINVAL);
+    errno = 0;
+    expect("prefix with '='", getopt_registry_add(&registry, "a=b", net) == -1 && errno == EINVAL);
+    expect("namespaces sorted",
+           registry.count == 4 && strcmp(registry.spaces[0].prefix, "") == 0 &&
+               strcmp(registry.spaces[1].prefix, "cache") == 0 && strcmp(registry.spaces[2].prefix, "cat") == 0 &&
+               strcmp(registry.spaces[3].prefix, "net") == 0);
+
+    for (i = 0; i < COUNT_OF(cases); i++)
+    {
+        run(&registry, &cases[i], trace, sizeof(trace));
+        if (strcmp(trace, cases[i].trace) != 0)
+        {
+            printf("FAIL: case %u: \"%s\", expected \"%s\"\n", (unsigned)i, trace, cases[i].trace);
+            failures++;
+        }
+    }
+
+    {
+        /* removing "cat" makes "--ca" an abbreviation of cache options only, and shifts "net" down */
+        static const registry_case after[] = {
+            {{"prog", "--cat.dir=x", "--net.port=1", "--ca", NULL}, 0, "?0@- p@2.0=1 ?0@-"},
+            {{"prog", "--cache.d=x", "--ca.dir=x", NULL}, 0, "d@1.0=x ?0@-"},
+        };
+
+        errno = 0;
+        expect("remove cat", getopt_registry_remove(&registry, "cat") == 0);
+        expect("remove again", getopt_registry_remove(&registry, "cat") == -1 && errno == ENOENT);
+        for (i = 0; i < COUNT_OF(after); i++)
+        {
+            run(&registry, &after[i], trace, sizeof(trace));
+            if (strcmp(trace, after[i].trace) != 0)
+            {
+                printf("FAIL: after removal %u: \"%s\", expected \"%s\"\n", (unsigned)i, trace, after[i].trace);
+                failures++;
+            }
+        }
+    }
+    getopt_registry_free(&registry);
+    expect("freed", registry.spaces == NULL && registry.count == 0);
+
+    if (failures == 0)
+        printf("all registry lookups as expected\n");
+    return (failures != 0);
+}
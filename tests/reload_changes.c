@@ -0,0 +1,118 @@
+/* SPDX-License-Identifier: 0BSD */
+
+/*
+ * Check the changes getopt_reload_apply() reports when an option is given
+ * several times. The n-th occurrence has to be compared with the previous
+ * n-th occurrence, whatever other options sit between them.
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <string.h>
+
+#define COUNT_OF(a) (sizeof(a) / sizeof((a)[0]))
+
+static const struct option long_options[] = {{"output", required_argument, NULL, 'o'},
+                                             {"verbose", no_argument, NULL, 'v'},
+                                             {NULL, 0, NULL, 0}};
+
+static int failures;
+
+static void expect(const char* what, int ok)
+{
+    if (!ok)
+    {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static int same_arg(const char* a, const char* b)
+{
+    return (a == NULL ? b == NULL : b != NULL && strcmp(a, b) == 0);
+}
+
+/*
+ * Apply argv as the only source and check that it produced exactly one
+ * change of the given kind.
+ */
+static void expect_change(struct getopt_reload* reload,
+                          const char*           what,
+                          int                   argc,
+                          char* const*          argv,
+                          int                   kind,
+                          int                   value,
+                          int                   occurrence,
+                          const char*           old_arg,
+                          const char*           new_arg)
+{
+    struct getopt_argv          source = {argc, argv};
+    const struct getopt_change* c;
+    int                         count  = getopt_reload_apply(reload, &source, 1);
+
+    if (count != 1)
+    {
+        printf("FAIL: %s: %d changes\n", what, count);
+        failures++;
+        return;
+    }
+    c = &reload->changes[0];
+    if (c->kind != kind || c->value != value || c->occurrence != occurrence || !same_arg(c->old_arg, old_arg) ||
+        !same_arg(c->new_arg, new_arg))
+    {
+        printf("FAIL: %s: kind %d value %d occurrence %d old %s new %s\n",
+               what,
+               c->kind,
+               c->value,
+               c->occurrence,
+               c->old_arg ? c->old_arg : "(null)",
+               c->new_arg ? c->new_arg : "(null)");
+        failures++;
+    }
+}
+
+int main(void)
+{
+    struct getopt_spec   spec     = {"o:v", long_options, 0, NULL};
+    struct getopt_reload reload;
+    char*                three[]  = {(char*)"prog", (char*)"-o", (char*)"a", (char*)"-v", (char*)"-o", (char*)"b",
+                                     (char*)"--output=c"};
+    char*                two[]    = {(char*)"prog", (char*)"-o", (char*)"a", (char*)"-v", (char*)"-o", (char*)"b"};
+    char*                edited[] = {(char*)"prog", (char*)"-o", (char*)"a", (char*)"-v", (char*)"-o", (char*)"b",
+                                     (char*)"-oZ"};
+    char*                four[]   = {(char*)"prog", (char*)"-o", (char*)"a", (char*)"-o", (char*)"b", (char*)"-oZ",
+                                     (char*)"-v", (char*)"-o", (char*)"d"};
+    char*                moved[]  = {(char*)"prog", (char*)"-v", (char*)"-o", (char*)"a", (char*)"-o", (char*)"b",
+                                     (char*)"-oZ", (char*)"-o", (char*)"d"};
+    struct getopt_argv   source   = {(int)COUNT_OF(three), three};
+    int                  i;
+
+    if (getopt_reload_init(&reload, &spec) != 0)
+    {
+        printf("getopt_reload_init failed\n");
+        return (1);
+    }
+    expect("first apply adds every occurrence", getopt_reload_apply(&reload, &source, 1) == 4);
+    for (i = 0; i < reload.current.count; i++)
+    {
+        const struct getopt_reload_entry* e = &reload.current.entries[i];
+        expect("occurrences numbered in parse order", e->occurrence == (e->value == 'o' ? i : 0));
+    }
+
+    expect_change(&reload, "third -o dropped", (int)COUNT_OF(two), two, GETOPT_CHANGE_REMOVED, 'o', 2, "c", NULL);
+    expect_change(
+        &reload, "third -o added back", (int)COUNT_OF(edited), edited, GETOPT_CHANGE_ADDED, 'o', 2, NULL, "Z");
+    expect_change(
+        &reload, "third -o changed", (int)COUNT_OF(three), three, GETOPT_CHANGE_CHANGED, 'o', 2, "Z", "c");
+    expect_change(&reload, "back to Z", (int)COUNT_OF(edited), edited, GETOPT_CHANGE_CHANGED, 'o', 2, "c", "Z");
+    expect_change(
+        &reload, "fourth -o added", (int)COUNT_OF(four), four, GETOPT_CHANGE_ADDED, 'o', 3, NULL, "d");
+    source.argc = (int)COUNT_OF(moved);
+    source.argv = moved;
+    expect("moving -v is no change", getopt_reload_apply(&reload, &source, 1) == 0);
+    getopt_reload_free(&reload);
+
+    if (failures == 0)
+        printf("all reload changes as expected\n");
+    return (failures != 0);
+}
@@ -0,0 +1,94 @@
+/* SPDX-License-Identifier: 0BSD */
+
+/*
+ * Check the GETOPT_MODE_SLASH syntax: which words starting with '/' are
+ * options and which are operands, how "/name:arg", "/x=arg" and an
+ * argument in the next word are taken, and how GETOPT_MODE_NOCASE applies.
+ * Each command line is reduced to a trace of the options returned, with
+ * their arguments or errors, followed by the operands.
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <string.h>
+
+#define COUNT_OF(a) (sizeof(a) / sizeof((a)[0]))
+#define MAX_WORDS   8
+
+static const struct option long_options[] = {{"out", required_argument, NULL, 'O'},
+                                             {"verbose", no_argument, NULL, 'v'},
+                                             {"level", optional_argument, NULL, 'l'},
+                                             {NULL, 0, NULL, 0}};
+
+typedef struct
+{
+    const char* words[MAX_WORDS];
+    int         mode;
+    const char* trace;
+} slash_case;
+
+static const slash_case cases[] = {
+    {{"prog", "/usr/bin", "/x", "/", "/:x", NULL}, GETOPT_MODE_SLASH, "| /usr/bin /x / /:x"},
+    {{"prog", "/out:file", "/OUT:file", NULL}, GETOPT_MODE_SLASH, "O=file | /OUT:file"},
+    {{"prog", "/OUT:file", "/Verbose", NULL}, GETOPT_MODE_SLASH | GETOPT_MODE_NOCASE, "O=file v |"},
+    {{"prog", "/o=x", "/o:y", "/ou=z", NULL}, GETOPT_MODE_SLASH, "o=x o=y O=z |"},
+    {{"prog", "/out", "file", "/o", "/tmp", "in", NULL}, GETOPT_MODE_SLASH, "O=file o=/tmp | in"},
+    {{"prog", "/level", "3", "/level:4", "/lev=5", NULL}, GETOPT_MODE_SLASH, "l l=4 l=5 | 3"},
+    {{"prog", "/v:1", "/verbose=1", "/verbose", NULL}, GETOPT_MODE_SLASH, "?4 ?4 v |"},
+    {{"prog", "in", "/v", "/o", NULL}, GETOPT_MODE_SLASH, "v ?3 | in"},
+    {{"prog", "/v", "--", "/o=x", NULL}, GETOPT_MODE_SLASH, "v | /o=x"},
+    {{"prog", "/o=x", "/verbose", "-v", NULL}, 0, "v | /o=x /verbose"},
+};
+
+static int failures;
+
+/*
+ * Parse one case and append "c", "c=arg" or "?error" per option, then "|"
+ * and the operands, to trace.
+ */
+static void run(const slash_case* sc, char* trace, size_t size)
+{
+    struct getopt_context ctx = GETOPT_CONTEXT_INIT;
+    char*                 argv[MAX_WORDS + 1];
+    size_t                used = 0;
+    int                   argc, c, i;
+
+    for (argc = 0; sc->words[argc] != NULL; argc++)
+        argv[argc] = (char*)sc->words[argc];
+    argv[argc] = NULL;
+    ctx.opterr = 0;
+    ctx.mode   = sc->mode;
+    trace[0]   = '\0';
+    while ((c = getopt_long_r(argc, argv, "o:v", long_options, NULL, &ctx)) != -1)
+    {
+        if (c == '?')
+            used += (size_t)snprintf(trace + used, size - used, "?%d ", ctx.error);
+        else if (ctx.optarg != NULL)
+            used += (size_t)snprintf(trace + used, size - used, "%c=%s ", c, ctx.optarg);
+        else
+            used += (size_t)snprintf(trace + used, size - used, "%c ", c);
+    }
+    used += (size_t)snprintf(trace + used, size - used, "|");
+    for (i = ctx.optind; i < argc; i++)
+        used += (size_t)snprintf(trace + used, size - used, " %s", argv[i]);
+}
+
+int main(void)
+{
+    char   trace[256];
+    size_t i;
+
+    for (i = 0; i < COUNT_OF(cases); i++)
+    {
+        run(&cases[i], trace, sizeof(trace));
+        if (strcmp(trace, cases[i].trace) != 0)
+        {
+            printf("FAIL: case %u: \"%s\", expected \"%s\"\n", (unsigned)i, trace, cases[i].trace);
+            failures++;
+        }
+    }
+
+    if (failures == 0)
+        printf("all slash options as expected\n");
+    return (failures != 0);
+}
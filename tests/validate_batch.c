@@ -0,0 +1,183 @@
+/* SPDX-License-Identifier: 0BSD */
+
+/*
+ * Check the verdicts of getopt_validate() on vectors with a known outcome,
+ * then check that getopt_validate_batch(), getopt_validate_range() and
+ * getopt_validate_batch_parallel() give the same verdicts as getopt_validate()
+ * on every vector of a large random batch. Built with GETOPT_THREADS, the
+ * parallel validator really runs on several threads.
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <string.h>
+
+#define COUNT_OF(a) (sizeof(a) / sizeof((a)[0]))
+#define BATCH       20000
+#define MAX_WORDS   6
+
+static const struct option long_options[] = {{"name", required_argument, NULL, 'n'},
+                                             {"names", no_argument, NULL, 'N'},
+                                             {"flag", no_argument, NULL, 'f'},
+                                             {NULL, 0, NULL, 0}};
+
+static const struct getopt_limits limits = {0, 16, 2, 0};
+
+typedef struct
+{
+    const char* words[MAX_WORDS];
+    int         limited; /* validate with limits */
+    int         error;
+    int         index;
+    int         optopt;
+} known_vector;
+
+static const known_vector known[] = {
+    {{"prog", "-a", "-b", "x", "file", NULL}, 0, GETOPT_ERROR_NONE, -1, 0},
+    {{"prog", "file", "-a", "-cfoo", NULL}, 0, GETOPT_ERROR_NONE, -1, 0},
+    {{"prog", "--", "-z", NULL}, 0, GETOPT_ERROR_NONE, -1, 0},
+    {{"prog", NULL}, 0, GETOPT_ERROR_NONE, -1, 0},
+    {{"prog", "-a", "-z", NULL}, 0, GETOPT_ERROR_UNKNOWN_OPTION, 2, 'z'},
+    {{"prog", "x", "-az", NULL}, 0, GETOPT_ERROR_UNKNOWN_OPTION, 2, 'z'},
+    {{"prog", "-a", "-b", NULL}, 0, GETOPT_ERROR_MISSING_ARGUMENT, 2, 'b'},
+    {{"prog", "--name", NULL}, 0, GETOPT_ERROR_MISSING_ARGUMENT, 1, 'n'},
+    {{"prog", "--flag=1", NULL}, 0, GETOPT_ERROR_UNEXPECTED_ARGUMENT, 1, 'f'},
+    {{"prog", "--nam", NULL}, 0, GETOPT_ERROR_AMBIGUOUS, 1, 0},
+    {{"prog", "--name", "x", "--bogus", NULL}, 0, GETOPT_ERROR_UNKNOWN_OPTION, 3, 0},
+    {{"prog", "-aa", "-aaa", NULL}, 1, GETOPT_ERROR_CLUSTER_TOO_LONG, 2, 'a'},
+    {{"prog", "-b", "0123456789abcdefg", NULL}, 1, GETOPT_ERROR_TOKEN_TOO_LONG, 1, 'b'},
+    {{"prog", "-b", "0123456789abcdefg", NULL}, 0, GETOPT_ERROR_NONE, -1, 0},
+};
+
+static const char* words[] = {"-a", "-b", "x", "-cv", "-z", "--name", "--name=x", "--names", "--nam", "--flag=1",
+                              "--flag", "--", "-", "file", "-ab", "--bogus", "-aaa", "-c"};
+
+static unsigned long rng_state = 7;
+
+static unsigned rng(unsigned n)
+{
+    rng_state = rng_state * 1103515245UL + 12345UL;
+    return ((unsigned)(rng_state >> 16) % n);
+}
+
+static int failures;
+
+static void expect(const char* what, int ok)
+{
+    if (!ok)
+    {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static int same_verdicts(const struct getopt_verdict* a, const struct getopt_verdict* b, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        if (a[i].error != b[i].error || a[i].index != b[i].index || a[i].optopt != b[i].optopt)
+        {
+            printf("vector %u: error %d/%d index %d/%d optopt %d/%d\n",
+                   (unsigned)i,
+                   a[i].error,
+                   b[i].error,
+                   a[i].index,
+                   b[i].index,
+                   a[i].optopt,
+                   b[i].optopt);
+            return (0);
+        }
+    }
+    return (1);
+}
+
+int main(void)
+{
+    static char*                 argvs[BATCH][MAX_WORDS + 1];
+    static struct getopt_argv    vectors[BATCH];
+    static struct getopt_verdict serial[BATCH], verdicts[BATCH];
+    static const unsigned        thread_counts[] = {0, 1, 2, 3, 8, 64, 1000};
+    struct getopt_spec           spec            = {"ab:c::", long_options, 0, NULL};
+    struct getopt_verdict        verdict;
+    size_t                       i, invalid = 0, first, n;
+    int                          argc, w, ret;
+
+    /* each known verdict */
+    for (i = 0; i < COUNT_OF(known); i++)
+    {
+        char* argv[MAX_WORDS + 1];
+        for (argc = 0; known[i].words[argc] != NULL; argc++)
+            argv[argc] = (char*)known[i].words[argc];
+        argv[argc]  = NULL;
+        spec.limits = known[i].limited ? &limits : NULL;
+        ret         = getopt_validate(&spec, argc, argv, &verdict);
+        if (ret != (known[i].error == GETOPT_ERROR_NONE ? 0 : -1) || verdict.error != known[i].error ||
+            verdict.index != known[i].index || verdict.optopt != known[i].optopt)
+        {
+            printf("FAIL: known vector %u: returned %d, error %d index %d optopt %d\n",
+                   (unsigned)i,
+                   ret,
+                   verdict.error,
+                   verdict.index,
+                   verdict.optopt);
+            failures++;
+        }
+    }
+    spec.limits = NULL;
+
+    /* a random batch, checked one vector at a time first */
+    for (i = 0; i < BATCH; i++)
+    {
+        argc        = (int)rng(MAX_WORDS + 1);
+        argvs[i][0] = (char*)"prog";
+        for (w = 1; w < argc; w++)
+            argvs[i][w] = (char*)words[rng(COUNT_OF(words))];
+        argvs[i][argc < 1 ? 1 : argc] = NULL;
+        vectors[i].argc               = argc;
+        vectors[i].argv               = argvs[i];
+        if (getopt_validate(&spec, argc, argvs[i], &serial[i]) != 0)
+            invalid++;
+    }
+
+    memset(verdicts, 0xA5, sizeof(verdicts));
+    expect("batch count", getopt_validate_batch(&spec, vectors, verdicts, BATCH) == invalid);
+    expect("batch verdicts", same_verdicts(serial, verdicts, BATCH));
+
+    memset(verdicts, 0xA5, sizeof(verdicts));
+    for (first = 0, n = 0; first < BATCH; first += 777)
+        n += getopt_validate_range(&spec, vectors, verdicts, first, first + 777 < BATCH ? first + 777 : BATCH);
+    expect("range count", n == invalid);
+    expect("range verdicts", same_verdicts(serial, verdicts, BATCH));
+
+    for (i = 0; i < COUNT_OF(thread_counts); i++)
+    {
+        memset(verdicts, 0xA5, sizeof(verdicts));
+        n = getopt_validate_batch_parallel(&spec, vectors, verdicts, BATCH, thread_counts[i]);
+        if (n != invalid || !same_verdicts(serial, verdicts, BATCH))
+        {
+            printf("FAIL: parallel with %u threads\n", thread_counts[i]);
+            failures++;
+        }
+    }
+    memset(verdicts, 0xA5, sizeof(verdicts));
+    expect("parallel over a short batch",
+           getopt_validate_batch_parallel(&spec, vectors, verdicts, 3, 8) ==
+                   (size_t)((serial[0].error != 0) + (serial[1].error != 0) + (serial[2].error != 0)) &&
+               same_verdicts(serial, verdicts, 3));
+
+    /* invalid arguments check nothing */
+    errno = 0;
+    expect("range with first > last", getopt_validate_range(&spec, vectors, verdicts, 5, 4) == 0 && errno == EINVAL);
+    errno = 0;
+    expect("batch without a spec", getopt_validate_batch(NULL, vectors, verdicts, BATCH) == 0 && errno == EINVAL);
+    errno = 0;
+    expect("parallel without verdicts",
+           getopt_validate_batch_parallel(&spec, vectors, NULL, BATCH, 4) == 0 && errno == EINVAL);
+
+    if (failures == 0)
+        printf("%u vectors, %u invalid, same verdicts on every path\n", (unsigned)BATCH, (unsigned)invalid);
+    return (failures != 0);
+}